@@ -0,0 +1,522 @@
+package main
+
+import (
+	"bufio"
+	"encoding/json"
+	"flag"
+	"fmt"
+	"io"
+	"os"
+	"os/exec"
+	"sort"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"text/tabwriter"
+	"time"
+	"unicode/utf16"
+)
+
+const (
+	maxLogLines   = 200 // All three variants keep the last 200 lines in the log view
+	taskQueueSize = 100 // cmd-queue-go / cmd-queue-win32-go channel size, C17 MAX_QUEUE_SIZE
+
+	// cmd-queue-go: tview's QueueUpdateDraw blocks once this many updates are pending
+	tviewUpdateQueueSize = 100
+	// cmd-queue-win32-go: PostMessage fails (and the line is never drawn) past the
+	// default per-thread posted message quota
+	postedMessageQuota = 10000
+)
+
+// A workload is a batch of identical tasks, each one running this binary's "emit" mode.
+type workload struct {
+	tasks int
+	args  []string
+	about string
+}
+
+var workloads = map[string]workload{
+	"flood":    {1000, []string{"-n", "0"}, "1000 tasks queued at once that exit immediately"},
+	"short":    {300, []string{"-n", "20", "-ms", "5"}, "300 tasks writing 20 lines and running 5 ms each"},
+	"output":   {4, []string{"-n", "200000", "-size", "100"}, "4 tasks writing 200k lines of 100 bytes flat out"},
+	"progress": {4, []string{"-mode", "progress", "-n", "50000"}, "4 tasks writing 50k \\r-terminated progress updates"},
+}
+
+var workloadOrder = []string{"flood", "short", "output", "progress"}
+var engineOrder = []string{"go-tview", "win32-go", "c17"}
+
+// Where make engine_bench leaves the c17 harness, relative to this directory.
+const defaultC17Bench = "../cmd-queue-win32-c17/engine_bench"
+
+type result struct {
+	Engine           string  `json:"engine"`
+	Workload         string  `json:"workload"`
+	Tasks            int     `json:"tasks"`
+	WallSec          float64 `json:"wall_s"`
+	DispatchP50Ms    float64 `json:"dispatch_p50_ms"`
+	DispatchP99Ms    float64 `json:"dispatch_p99_ms"`
+	DispatchMaxMs    float64 `json:"dispatch_max_ms"`
+	LinesRead        int64   `json:"lines_read"`
+	LinesShown       int64   `json:"lines_shown"`
+	LinesDropped     int64   `json:"lines_dropped"`
+	ReadLinesPerSec  float64 `json:"read_lines_per_s"`
+	ShownLinesPerSec float64 `json:"shown_lines_per_s"`
+	UIBytes          int64   `json:"ui_bytes"`
+	ReadErrors       int64   `json:"read_errors"`
+	CPUSec           float64 `json:"cpu_s"`
+	ChildCPUSec      float64 `json:"child_cpu_s"`
+	PeakRSSMB        float64 `json:"peak_rss_mb"`
+}
+
+func main() {
+	if len(os.Args) < 2 {
+		usage()
+	}
+	switch os.Args[1] {
+	case "emit":
+		emit(os.Args[2:])
+	case "run":
+		runSuite(os.Args[2:])
+	case "one":
+		runOne(os.Args[2:])
+	default:
+		usage()
+	}
+}
+
+func usage() {
+	fmt.Fprintln(os.Stderr, "usage: cmdq-bench run [-engines go-tview,win32-go,c17] [-workloads flood,short,output,progress] [-scale 1] [-json] [-c17 path]")
+	fmt.Fprintln(os.Stderr, "       cmdq-bench emit [-mode lines|progress] [-n lines] [-size bytes] [-rate lines/s] [-ms sleep]")
+	fmt.Fprintln(os.Stderr, "workloads:")
+	for _, name := range workloadOrder {
+		fmt.Fprintf(os.Stderr, "  %-9s %s\n", name, workloads[name].about)
+	}
+	os.Exit(2)
+}
+
+// --- Workload Child ---
+
+// emit is the synthetic task. It is also meant to be queued by hand in the Windows
+// builds (cmdq-bench.exe emit -n 100000) to compare them on the same output.
+func emit(args []string) {
+	fs := flag.NewFlagSet("emit", flag.ExitOnError)
+	mode := fs.String("mode", "lines", "lines or progress (\\r-terminated updates, one final \\n)")
+	n := fs.Int("n", 1000, "Lines or progress updates to write")
+	size := fs.Int("size", 80, "Bytes per line")
+	rate := fs.Int("rate", 0, "Lines per second, 0 for as fast as possible")
+	sleepMs := fs.Int("ms", 0, "Milliseconds to run after writing")
+	fs.Parse(args)
+
+	w := bufio.NewWriterSize(os.Stdout, 64*1024)
+	pad := strings.Repeat("x", atLeast(*size-32, 0))
+	start := time.Now()
+	for i := 0; i < *n; i++ {
+		if *rate > 0 {
+			due := start.Add(time.Duration(i) * time.Second / time.Duration(*rate))
+			if wait := time.Until(due); wait > 0 {
+				w.Flush()
+				time.Sleep(wait)
+			}
+		}
+		if *mode == "progress" {
+			end := byte('\r')
+			if i == *n-1 {
+				end = '\n'
+			}
+			fmt.Fprintf(w, "[download] %5.1f%% of %d %s%c", float64(i+1)*100/float64(*n), *n, pad, end)
+		} else {
+			fmt.Fprintf(w, "line %08d %s\n", i, pad)
+		}
+	}
+	w.Flush()
+	time.Sleep(time.Duration(*sleepMs) * time.Millisecond)
+}
+
+// --- Suite ---
+
+// runSuite runs every engine/workload pair in its own process, so peak RSS and CPU
+// belong to that pair alone, and prints one row per pair.
+func runSuite(args []string) {
+	fs := flag.NewFlagSet("run", flag.ExitOnError)
+	engines := fs.String("engines", strings.Join(engineOrder, ","), "Engines to run")
+	names := fs.String("workloads", strings.Join(workloadOrder, ","), "Workloads to run")
+	scale := fs.Float64("scale", 1, "Multiplier for the number of tasks")
+	asJSON := fs.Bool("json", false, "Print one JSON object per run instead of a table")
+	c17Bench := fs.String("c17", defaultC17Bench, "cmd-queue-win32-c17's engine_bench binary (make engine_bench)")
+	fs.Parse(args)
+
+	exe, err := os.Executable()
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(1)
+	}
+
+	var results []result
+	for _, wl := range strings.Split(*names, ",") {
+		for _, eng := range strings.Split(*engines, ",") {
+			out, err := exec.Command(exe, "one", "-engine", eng, "-workload", wl, "-scale", fmt.Sprint(*scale), "-c17", *c17Bench).Output()
+			if err != nil {
+				fmt.Fprintf(os.Stderr, "%s/%s: %v\n", eng, wl, err)
+				continue
+			}
+			var r result
+			if err := json.Unmarshal(out, &r); err != nil {
+				fmt.Fprintf(os.Stderr, "%s/%s: %v\n", eng, wl, err)
+				continue
+			}
+			if *asJSON {
+				os.Stdout.Write(out)
+			}
+			results = append(results, r)
+		}
+	}
+	if *asJSON {
+		return
+	}
+
+	tw := tabwriter.NewWriter(os.Stdout, 0, 0, 2, ' ', tabwriter.AlignRight)
+	fmt.Fprintln(tw, "workload\tengine\ttasks\twall s\tdispatch p50 ms\tp99 ms\tmax ms\tread lines/s\tshown lines/s\tdropped\tUI MB\tread errs\tcpu s\tchild cpu s\tpeak RSS MB\t")
+	for _, r := range results {
+		fmt.Fprintf(tw, "%s\t%s\t%d\t%.2f\t%.3f\t%.3f\t%.3f\t%.0f\t%.0f\t%d\t%.1f\t%d\t%.2f\t%.2f\t%.1f\t\n",
+			r.Workload, r.Engine, r.Tasks, r.WallSec, r.DispatchP50Ms, r.DispatchP99Ms, r.DispatchMaxMs,
+			r.ReadLinesPerSec, r.ShownLinesPerSec, r.LinesDropped, float64(r.UIBytes)/(1<<20),
+			r.ReadErrors, r.CPUSec, r.ChildCPUSec, r.PeakRSSMB)
+	}
+	tw.Flush()
+}
+
+func runOne(args []string) {
+	fs := flag.NewFlagSet("one", flag.ExitOnError)
+	engineName := fs.String("engine", "c17", "Engine to run")
+	name := fs.String("workload", "short", "Workload to run")
+	scale := fs.Float64("scale", 1, "Multiplier for the number of tasks")
+	c17Bench := fs.String("c17", defaultC17Bench, "cmd-queue-win32-c17's engine_bench binary (make engine_bench)")
+	fs.Parse(args)
+
+	wl, ok := workloads[*name]
+	if !ok {
+		fmt.Fprintf(os.Stderr, "unknown workload %q\n", *name)
+		os.Exit(2)
+	}
+	tasks := atLeast(int(float64(wl.tasks)**scale), 1)
+	var r result
+	if *engineName == "c17" {
+		r = runC17(*c17Bench, wl.args, tasks)
+	} else {
+		r = runGoEngine(*engineName, wl.args, tasks)
+	}
+	r.Engine, r.Workload = *engineName, *name
+	out, _ := json.Marshal(r)
+	fmt.Println(string(out))
+}
+
+func runGoEngine(name string, args []string, tasks int) result {
+	b := &bench{}
+	var e engine
+	switch name {
+	case "go-tview":
+		e = &tviewEngine{b: b}
+		b.ui = make(chan func(), tviewUpdateQueueSize)
+	case "win32-go":
+		e = &win32GoEngine{b: b}
+		b.ui = make(chan func(), postedMessageQuota)
+	default:
+		fmt.Fprintf(os.Stderr, "unknown engine %q\n", name)
+		os.Exit(2)
+	}
+	return b.run(e, args, tasks)
+}
+
+// runC17 runs the C17 app's own scheduler.c and tasklog.c through its host-built
+// engine_bench, so the row measures that code rather than a copy of it. The harness
+// reports its own CPU, child CPU and peak RSS, which leaves this process out of them.
+func runC17(path string, args []string, tasks int) result {
+	exe, _ := os.Executable()
+	cmdArgs := append([]string{fmt.Sprint(tasks), exe, "emit"}, args...)
+	cmd := exec.Command(path, cmdArgs...)
+	cmd.Stderr = os.Stderr
+	out, err := cmd.Output()
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "%s: %v (build it with make engine_bench in cmd-queue-win32-c17)\n", path, err)
+		os.Exit(1)
+	}
+	var r result
+	if err := json.Unmarshal(out, &r); err != nil {
+		fmt.Fprintf(os.Stderr, "%s: %v\n", path, err)
+		os.Exit(1)
+	}
+	return r
+}
+
+// --- Harness ---
+
+// bench is the part every engine shares: a task queue, a pool of workers starting the
+// children, and one goroutine standing in for the UI thread that runs whatever the
+// engine posts to it, in order.
+type bench struct {
+	ui           chan func()
+	linesRead    int64
+	linesShown   int64
+	linesDropped int64
+	uiBytes      int64 // Bytes the UI thread rebuilt or converted to draw the log
+	readErrors   int64
+
+	latencyLock sync.Mutex
+	latencies   []time.Duration
+}
+
+type queuedTask struct {
+	args     []string
+	enqueued time.Time
+}
+
+// A taskQueue is a variant's dispatch path: how a queued task reaches a free worker.
+type taskQueue interface {
+	push(t queuedTask)       // Blocks while the queue is full
+	close()                  // No more tasks; pop drains the rest, then returns false
+	pop() (queuedTask, bool) // Blocks until a task may start
+}
+
+// An engine reproduces one variant's dispatch and log path minus its window: how many
+// workers start tasks and how, how child output is cut into lines and what reaches the
+// UI thread.
+type engine interface {
+	workers() int
+	newQueue() taskQueue
+	read(r io.Reader)
+	note(line string) // Lines the engine logs itself ("$ cmd", exit code)
+}
+
+func (b *bench) run(e engine, args []string, tasks int) result {
+	exe, _ := os.Executable()
+	childArgs := append([]string{"emit"}, args...)
+	cpuStart, childStart, _ := resourceUsage()
+
+	uiDone := make(chan struct{})
+	go func() {
+		for f := range b.ui {
+			f()
+		}
+		close(uiDone)
+	}()
+
+	start := time.Now()
+	queue := e.newQueue()
+	var wg sync.WaitGroup
+	for i := 0; i < e.workers(); i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			b.worker(e, exe, queue)
+		}()
+	}
+	for i := 0; i < tasks; i++ {
+		queue.push(queuedTask{childArgs, time.Now()})
+	}
+	queue.close()
+	wg.Wait()
+	close(b.ui)
+	<-uiDone
+	wall := time.Since(start)
+
+	cpuEnd, childEnd, peakRSS := resourceUsage()
+	sort.Slice(b.latencies, func(i, j int) bool { return b.latencies[i] < b.latencies[j] })
+	return result{
+		Tasks:            tasks,
+		WallSec:          wall.Seconds(),
+		DispatchP50Ms:    percentileMs(b.latencies, 0.50),
+		DispatchP99Ms:    percentileMs(b.latencies, 0.99),
+		DispatchMaxMs:    percentileMs(b.latencies, 1.0),
+		LinesRead:        b.linesRead,
+		LinesShown:       b.linesShown,
+		LinesDropped:     b.linesDropped,
+		ReadLinesPerSec:  float64(b.linesRead) / wall.Seconds(),
+		ShownLinesPerSec: float64(b.linesShown) / wall.Seconds(),
+		UIBytes:          b.uiBytes,
+		ReadErrors:       b.readErrors,
+		CPUSec:           (cpuEnd - cpuStart).Seconds(),
+		ChildCPUSec:      (childEnd - childStart).Seconds(),
+		PeakRSSMB:        peakRSS,
+	}
+}
+
+// worker runs tasks one at a time like each variant's command processor. Dispatch
+// latency is the time from "task queued and this worker free" to "child started", so it
+// covers the engine's queue as well as starting the child.
+func (b *bench) worker(e engine, exe string, queue taskQueue) {
+	for {
+		free := time.Now()
+		task, ok := queue.pop()
+		if !ok {
+			return
+		}
+		ready := free
+		if task.enqueued.After(ready) {
+			ready = task.enqueued
+		}
+
+		e.note("$ " + exe + " " + strings.Join(task.args, " "))
+		cmd := exec.Command(exe, task.args...)
+		stdout, err1 := cmd.StdoutPipe()
+		stderr, err2 := cmd.StderrPipe()
+		if err1 != nil || err2 != nil || cmd.Start() != nil {
+			atomic.AddInt64(&b.readErrors, 1)
+			continue
+		}
+		latency := time.Since(ready)
+		b.latencyLock.Lock()
+		b.latencies = append(b.latencies, latency)
+		b.latencyLock.Unlock()
+
+		var readers sync.WaitGroup
+		readers.Add(2)
+		go func() {
+			defer readers.Done()
+			e.read(stdout)
+		}()
+		go func() {
+			defer readers.Done()
+			e.read(stderr)
+		}()
+		readers.Wait()
+		exitCode := 0
+		if err := cmd.Wait(); err != nil {
+			exitCode = -1
+			if exitErr, ok := err.(*exec.ExitError); ok {
+				exitCode = exitErr.ExitCode()
+			}
+		}
+		e.note(fmt.Sprintf("Process finished. Exit code: %d", exitCode))
+	}
+}
+
+// chanQueue: both Go variants hand tasks to their command processor through a buffered
+// channel of taskQueueSize.
+type chanQueue chan queuedTask
+
+func (q chanQueue) push(t queuedTask) { q <- t }
+func (q chanQueue) close()            { close(q) }
+
+func (q chanQueue) pop() (queuedTask, bool) {
+	t, ok := <-q
+	return t, ok
+}
+
+func percentileMs(sorted []time.Duration, p float64) float64 {
+	if len(sorted) == 0 {
+		return 0
+	}
+	i := int(float64(len(sorted)-1) * p)
+	return float64(sorted[i].Microseconds()) / 1000
+}
+
+func atLeast(v, min int) int {
+	if v < min {
+		return min
+	}
+	return v
+}
+
+// --- cmd-queue-go ---
+
+// tviewEngine: one worker, bufio.Scanner per pipe, and every line queues a redraw that
+// joins the whole 200-line log. A line longer than the scanner's 64 KB limit (a progress
+// storm without \n) stops the reader; the real app then stalls, here the rest is drained
+// and counted as a read error.
+type tviewEngine struct {
+	b        *bench
+	lock     sync.Mutex
+	logLines []string
+}
+
+func (e *tviewEngine) workers() int        { return 1 }
+func (e *tviewEngine) newQueue() taskQueue { return make(chanQueue, taskQueueSize) }
+
+func (e *tviewEngine) read(r io.Reader) {
+	scanner := bufio.NewScanner(r)
+	for scanner.Scan() {
+		atomic.AddInt64(&e.b.linesRead, 1)
+		e.addToLog(scanner.Text(), true)
+	}
+	if scanner.Err() != nil {
+		atomic.AddInt64(&e.b.readErrors, 1)
+		io.Copy(io.Discard, r)
+	}
+}
+
+func (e *tviewEngine) note(line string) { e.addToLog(line, false) }
+
+func (e *tviewEngine) addToLog(line string, fromTask bool) {
+	e.lock.Lock()
+	e.logLines = append(e.logLines, line)
+	if len(e.logLines) > maxLogLines {
+		e.logLines = e.logLines[len(e.logLines)-maxLogLines:]
+	}
+	e.lock.Unlock()
+
+	e.b.ui <- func() { // QueueUpdateDraw blocks while tview's update queue is full
+		e.lock.Lock()
+		text := strings.Join(e.logLines, "\n")
+		e.lock.Unlock()
+		e.b.uiBytes += int64(len(text))
+		if fromTask {
+			e.b.linesShown++
+		}
+	}
+}
+
+// --- cmd-queue-win32-go ---
+
+// win32GoEngine: one worker, bufio.Reader per pipe, and every line posts a message
+// whose handler joins the whole log and converts it to UTF-16 for SetWindowText.
+// Once the posted message quota is reached the post fails and that redraw is lost.
+type win32GoEngine struct {
+	b        *bench
+	lock     sync.Mutex
+	logLines []string
+}
+
+func (e *win32GoEngine) workers() int        { return 1 }
+func (e *win32GoEngine) newQueue() taskQueue { return make(chanQueue, taskQueueSize) }
+
+func (e *win32GoEngine) read(r io.Reader) {
+	reader := bufio.NewReader(r)
+	for {
+		line, err := reader.ReadString('\n')
+		if len(line) > 0 {
+			atomic.AddInt64(&e.b.linesRead, 1)
+			e.addToLog(strings.TrimRight(line, "\r\n"), true)
+		}
+		if err != nil {
+			return
+		}
+	}
+}
+
+func (e *win32GoEngine) note(line string) { e.addToLog(line, false) }
+
+func (e *win32GoEngine) addToLog(line string, fromTask bool) {
+	e.lock.Lock()
+	e.logLines = append(e.logLines, line)
+	if len(e.logLines) > maxLogLines {
+		e.logLines = e.logLines[len(e.logLines)-maxLogLines:]
+	}
+	e.lock.Unlock()
+
+	update := func() {
+		e.lock.Lock()
+		text := strings.Join(e.logLines, "\r\n")
+		e.lock.Unlock()
+		e.b.uiBytes += int64(len(utf16.Encode([]rune(text))) * 2)
+		if fromTask {
+			e.b.linesShown++
+		}
+	}
+	select {
+	case e.b.ui <- update:
+	default:
+		if fromTask {
+			atomic.AddInt64(&e.b.linesDropped, 1)
+		}
+	}
+}
@@ -0,0 +1,21 @@
+//go:build linux
+
+package main
+
+import (
+	"syscall"
+	"time"
+)
+
+// resourceUsage returns the CPU time (user + system) of this process and of its waited-for
+// children so far, and this process's peak RSS in MB.
+func resourceUsage() (self, children time.Duration, peakRSSMB float64) {
+	var ru syscall.Rusage
+	syscall.Getrusage(syscall.RUSAGE_SELF, &ru)
+	self = time.Duration(ru.Utime.Nano() + ru.Stime.Nano())
+	peakRSSMB = float64(ru.Maxrss) / 1024 // Maxrss is in KB on Linux
+
+	syscall.Getrusage(syscall.RUSAGE_CHILDREN, &ru)
+	children = time.Duration(ru.Utime.Nano() + ru.Stime.Nano())
+	return self, children, peakRSSMB
+}
@@ -0,0 +1,600 @@
+// Host-built harness that runs the app's dispatch and log path without its window, for
+// cmd-queue-bench (make engine_bench, Linux). Workers take tasks through scheduler.c and
+// pipe readers cut and budget output through tasklog.c, exactly as main.c does; only the
+// Win32 plumbing around them is replaced: pthreads for the threads, critical sections and
+// condition variables, posix_spawn for LaunchChildProcess, and a thread draining a message
+// list for the UI thread and its 200-line edit control.
+//
+//   engine_bench <tasks> <child argv...>
+//
+// Runs <tasks> copies of the child in one group with --max-running 4 and prints one JSON
+// object with the fields of cmd-queue-bench's result.
+#define _GNU_SOURCE // pipe2
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#include "scheduler.h"
+#include "tasklog.h"
+
+extern char** environ;
+
+// --- Configuration ---
+// As in main.c
+#define MAX_LOG_LINES_IN_EDIT_CONTROL 200
+#define WORKER_THREAD_COUNT 4
+#define TIMER_TICK_MS 100
+#define MAX_PENDING_LOG_CHUNKS 512
+#define GROUP_MAX_RUNNING 4
+#define POSTED_MESSAGE_QUOTA 10000 // PostMessage fails past the default per-thread quota
+
+// --- Structures ---
+typedef struct {
+    long task_id;
+    char tag[48];
+} TaskLogTag;
+
+typedef struct {
+    pthread_mutex_t lock;          // Guards budget
+    const TaskLogTag* tag;
+    TaskLogBudget budget;
+} TaskLog;
+
+typedef struct {
+    int pipe;
+    int is_stderr;
+    TaskLog* log;
+} PipeReaderContext;
+
+// One posted WM_APP_APPEND_LOG_CHUNK, text converted to UTF-16 as Utf8ToWide does.
+typedef struct LogChunk {
+    uint16_t* text;
+    size_t len;
+    int is_progress_line;
+    long task_id;
+    int from_task;                 // Child output rather than the app's own message
+    struct LogChunk* next;
+} LogChunk;
+
+typedef struct {
+    long task_id;
+    unsigned long long line;
+} LogProgressLine;
+
+// --- Global Variables ---
+static Scheduler g_scheduler;
+static pthread_mutex_t g_queueLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_queueNotEmpty;
+static pthread_cond_t g_queueNotFull;  // The app rejects a task when the queue is full; here the producer waits
+static int g_queueClosed = 0;
+static double* g_enqueuedSec;          // Per task, indexed by the number in its suffix
+static char** g_childArgv;
+static long g_lastLogTaskId = 0;
+
+// Message queue of the stand-in UI thread
+static pthread_mutex_t g_messageLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_messageReady = PTHREAD_COND_INITIALIZER;
+static LogChunk* g_messageHead = NULL;
+static LogChunk* g_messageTail = NULL;
+static int g_messageCount = 0;
+static int g_uiExiting = 0;
+
+// Backpressure, as g_logRoomLock / g_logRoom
+static pthread_mutex_t g_logRoomLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_logRoom = PTHREAD_COND_INITIALIZER;
+static long g_pendingLogChunks = 0;
+
+// The edit control: its last MAX_LOG_LINES_IN_EDIT_CONTROL lines. UI thread only.
+static uint16_t* g_logLines[MAX_LOG_LINES_IN_EDIT_CONTROL];
+static unsigned long long g_logLinesAppended = 0;
+static LogProgressLine g_logProgressLines[WORKER_THREAD_COUNT];
+
+// Results
+static long long g_linesRead = 0, g_linesShown = 0, g_linesDropped = 0;
+static long long g_uiBytes = 0, g_readErrors = 0;
+static pthread_mutex_t g_latencyLock = PTHREAD_MUTEX_INITIALIZER;
+static double* g_latencies;
+static int g_latencyCount = 0;
+
+// --- Clock ---
+static double NowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Stands in for GetTickCount64.
+static unsigned long long TickMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000 + (unsigned long long)ts.tv_nsec / 1000000;
+}
+
+// --- String Utilities ---
+// UTF-8 to UTF-16 code units, invalid bytes becoming U+FFFD, as MultiByteToWideChar does.
+static uint16_t* Utf8ToUtf16(const char* utf8, size_t* outLen) {
+    size_t len = strlen(utf8);
+    uint16_t* out = (uint16_t*)malloc((len + 1) * sizeof(uint16_t));
+    if (!out) return NULL;
+    size_t n = 0;
+    const unsigned char* s = (const unsigned char*)utf8;
+    for (size_t i = 0; i < len;) {
+        unsigned int c = s[i], cp = 0xFFFD;
+        int extra = c < 0x80 ? 0 : (c >> 5) == 6 ? 1 : (c >> 4) == 14 ? 2 : (c >> 3) == 30 ? 3 : -1;
+        if (extra == 0) {
+            cp = c;
+        } else if (extra > 0 && i + (size_t)extra < len) {
+            cp = c & (0x3F >> extra);
+            for (int k = 1; k <= extra; ++k) {
+                if ((s[i + k] & 0xC0) != 0x80) { cp = 0xFFFD; extra = k - 1; break; }
+                cp = (cp << 6) | (s[i + k] & 0x3F);
+            }
+        } else {
+            extra = 0;
+        }
+        i += (size_t)extra + 1;
+        if (cp >= 0x10000) {
+            out[n++] = (uint16_t)(0xD800 + ((cp - 0x10000) >> 10));
+            out[n++] = (uint16_t)(0xDC00 + ((cp - 0x10000) & 0x3FF));
+        } else {
+            out[n++] = (uint16_t)cp;
+        }
+    }
+    out[n] = 0;
+    *outLen = n;
+    return out;
+}
+
+// --- UI Thread ---
+static void LogChunkDone(void) {
+    pthread_mutex_lock(&g_logRoomLock);
+    if (--g_pendingLogChunks == MAX_PENDING_LOG_CHUNKS - 1) pthread_cond_broadcast(&g_logRoom);
+    pthread_mutex_unlock(&g_logRoomLock);
+}
+
+static void FreeLogChunk(LogChunk* chunk) {
+    free(chunk->text);
+    free(chunk);
+}
+
+// Follows AppendLogChunk, with the edit control reduced to a ring of lines. UI bytes are
+// the UTF-16 bytes handed to EM_REPLACESEL.
+static void AppendLogChunk(const LogChunk* chunk) {
+    LogProgressLine* progress = NULL;
+    if (chunk->task_id != 0) {
+        for (int i = 0; i < WORKER_THREAD_COUNT; ++i) {
+            if (g_logProgressLines[i].task_id == chunk->task_id) progress = &g_logProgressLines[i];
+        }
+    }
+    unsigned long long trimmed = g_logLinesAppended > MAX_LOG_LINES_IN_EDIT_CONTROL
+                               ? g_logLinesAppended - MAX_LOG_LINES_IN_EDIT_CONTROL : 0;
+
+    uint16_t* copy = (uint16_t*)malloc((chunk->len + 1) * sizeof(uint16_t));
+    if (!copy) return;
+    memcpy(copy, chunk->text, (chunk->len + 1) * sizeof(uint16_t));
+    g_uiBytes += (long long)(chunk->len * sizeof(uint16_t));
+
+    if (progress && chunk->is_progress_line && progress->line >= trimmed) {
+        uint16_t** slot = &g_logLines[progress->line % MAX_LOG_LINES_IN_EDIT_CONTROL];
+        free(*slot);
+        *slot = copy;
+        return;
+    }
+    if (progress) progress->task_id = 0;
+
+    if (g_logLinesAppended > 0) g_uiBytes += 2 * sizeof(uint16_t); // "\r\n"
+    unsigned long long line = g_logLinesAppended++;
+    uint16_t** slot = &g_logLines[line % MAX_LOG_LINES_IN_EDIT_CONTROL];
+    free(*slot); // The line trimmed from the top
+    *slot = copy;
+
+    if (chunk->is_progress_line && chunk->task_id != 0) {
+        LogProgressLine* progressSlot = &g_logProgressLines[0];
+        for (int i = 0; i < WORKER_THREAD_COUNT; ++i) {
+            if (g_logProgressLines[i].task_id == 0) { progressSlot = &g_logProgressLines[i]; break; }
+            if (g_logProgressLines[i].line < progressSlot->line) progressSlot = &g_logProgressLines[i];
+        }
+        progressSlot->task_id = chunk->task_id;
+        progressSlot->line = line;
+    }
+}
+
+static void* UIThread(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_messageLock);
+    for (;;) {
+        while (!g_messageHead && !g_uiExiting) pthread_cond_wait(&g_messageReady, &g_messageLock);
+        LogChunk* chunk = g_messageHead;
+        if (!chunk) break;
+        g_messageHead = chunk->next;
+        if (!g_messageHead) g_messageTail = NULL;
+        g_messageCount--;
+        pthread_mutex_unlock(&g_messageLock);
+
+        LogChunkDone();
+        AppendLogChunk(chunk);
+        if (chunk->from_task) g_linesShown++;
+        FreeLogChunk(chunk);
+
+        pthread_mutex_lock(&g_messageLock);
+    }
+    pthread_mutex_unlock(&g_messageLock);
+    for (int i = 0; i < MAX_LOG_LINES_IN_EDIT_CONTROL; ++i) free(g_logLines[i]);
+    return NULL;
+}
+
+// As PostLogChunk once the window exists.
+static void PostLogChunk(LogChunk* chunk) {
+    pthread_mutex_lock(&g_logRoomLock);
+    g_pendingLogChunks++;
+    pthread_mutex_unlock(&g_logRoomLock);
+
+    pthread_mutex_lock(&g_messageLock);
+    if (g_messageCount >= POSTED_MESSAGE_QUOTA) {
+        pthread_mutex_unlock(&g_messageLock);
+        LogChunkDone();
+        FreeLogChunk(chunk);
+        return;
+    }
+    chunk->next = NULL;
+    if (g_messageTail) g_messageTail->next = chunk;
+    else g_messageHead = chunk;
+    g_messageTail = chunk;
+    g_messageCount++;
+    pthread_cond_signal(&g_messageReady);
+    pthread_mutex_unlock(&g_messageLock);
+}
+
+static void PostTaskLogLine(const TaskLogTag* tag, const char* line, int isProgress, int fromTask) {
+    size_t textLen = strlen(tag->tag) + 1 + strlen(line) + 1;
+    char* text = (char*)malloc(textLen);
+    LogChunk* chunk = (LogChunk*)malloc(sizeof(LogChunk));
+    if (!text || !chunk) {
+        free(text);
+        free(chunk);
+        return;
+    }
+    snprintf(text, textLen, "%s %s", tag->tag, line);
+    chunk->text = Utf8ToUtf16(text, &chunk->len);
+    free(text);
+    if (!chunk->text) {
+        free(chunk);
+        return;
+    }
+    chunk->is_progress_line = isProgress;
+    chunk->task_id = tag->task_id;
+    chunk->from_task = fromTask;
+    PostLogChunk(chunk);
+}
+
+// --- Log Budget ---
+// SubmitTaskLogLine, ReportSuppressedLines and FlushTaskLog as in main.c.
+static void ReportSuppressedLines(TaskLog* log, unsigned long long now) {
+    unsigned long long lines, bytes;
+    if (!TaskLogBudgetTakeReport(&log->budget, now, &lines, &bytes)) return;
+    char msg[128];
+    snprintf(msg, sizeof(msg), "\xE2\x80\xA6 %llu lines suppressed (%llu bytes) \xE2\x80\xA6", lines, bytes);
+    PostTaskLogLine(log->tag, msg, 0, 0);
+}
+
+static void SubmitTaskLogLine(TaskLog* log, const char* line, int isProgress) {
+    __atomic_add_fetch(&g_linesRead, 1, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&log->lock);
+    unsigned long long now = TickMs();
+    TaskLogDecision decision = TaskLogBudgetSubmit(&log->budget, line, isProgress, now);
+    if (decision.budget_exhausted) {
+        PostTaskLogLine(log->tag, "\xE2\x80\xA6 log budget for this task reached, further output is only counted \xE2\x80\xA6", 0, 0);
+    }
+    pthread_mutex_unlock(&log->lock);
+
+    if (!decision.show && !decision.report_due) return;
+
+    pthread_mutex_lock(&g_logRoomLock);
+    while (g_pendingLogChunks >= MAX_PENDING_LOG_CHUNKS) pthread_cond_wait(&g_logRoom, &g_logRoomLock);
+    pthread_mutex_unlock(&g_logRoomLock);
+
+    pthread_mutex_lock(&log->lock);
+    if (decision.report_due) ReportSuppressedLines(log, now);
+    if (decision.show) PostTaskLogLine(log->tag, line, isProgress, 1);
+    pthread_mutex_unlock(&log->lock);
+}
+
+static void FlushTaskLog(TaskLog* log) {
+    pthread_mutex_lock(&log->lock);
+    char* progress = TaskLogBudgetTakePendingProgress(&log->budget);
+    if (progress) {
+        PostTaskLogLine(log->tag, progress, 1, 1);
+        free(progress);
+        __atomic_sub_fetch(&g_linesDropped, 1, __ATOMIC_RELAXED);
+    }
+    ReportSuppressedLines(log, TickMs());
+    pthread_mutex_unlock(&log->lock);
+}
+
+static void SubmitPipeLine(void* lineCtx, const char* line, int flags) {
+    PipeReaderContext* ctx = (PipeReaderContext*)lineCtx;
+    SubmitTaskLogLine(ctx->log, line, (flags & LINE_PROGRESS) != 0);
+    if (flags & LINE_PART) {
+        pthread_mutex_lock(&ctx->log->lock);
+        if (!ctx->log->budget.long_line_reported) {
+            ctx->log->budget.long_line_reported = 1;
+            PostTaskLogLine(ctx->log->tag, "\xE2\x80\xA6 very long output line split into parts \xE2\x80\xA6", 0, 0);
+        }
+        pthread_mutex_unlock(&ctx->log->lock);
+    }
+}
+
+static void* PipeReaderThread(void* arg) {
+    PipeReaderContext* ctx = (PipeReaderContext*)arg;
+    char buffer[PIPE_BUFFER_SIZE];
+    LineSplitter splitter;
+    LineSplitterInit(&splitter);
+    for (;;) {
+        ssize_t bytesRead = read(ctx->pipe, buffer, sizeof(buffer));
+        if (bytesRead < 0 && errno == EINTR) continue;
+        if (bytesRead <= 0) break;
+        LineSplitterFeed(&splitter, buffer, (size_t)bytesRead, SubmitPipeLine, ctx);
+    }
+    LineSplitterFinish(&splitter, SubmitPipeLine, ctx);
+    return NULL;
+}
+
+// --- Command Queue & Processing ---
+static void WakeWorkers(SchedulerWake wake) {
+    if (wake == SCHEDULER_WAKE_ALL) pthread_cond_broadcast(&g_queueNotEmpty);
+    else if (wake == SCHEDULER_WAKE_ONE) pthread_cond_signal(&g_queueNotEmpty);
+}
+
+static int AddToQueue(int taskNumber) {
+    wchar_t suffix[16];
+    swprintf(suffix, sizeof(suffix)/sizeof(wchar_t), L"%d", taskNumber);
+    QueuedTask task = { wcsdup(L""), wcsdup(suffix), 0, 0, 0, 0, 0 };
+    if (!task.prefix || !task.suffix) {
+        free(task.prefix);
+        free(task.suffix);
+        return 0;
+    }
+
+    pthread_mutex_lock(&g_queueLock);
+    g_enqueuedSec[taskNumber] = NowSec();
+    SchedulerWake wake;
+    SchedulerAddResult added;
+    while ((added = SchedulerAdd(&g_scheduler, &task, TickMs(), &wake)) == SCHEDULER_QUEUE_FULL) {
+        pthread_cond_wait(&g_queueNotFull, &g_queueLock);
+    }
+    WakeWorkers(wake);
+    pthread_mutex_unlock(&g_queueLock);
+
+    if (added == SCHEDULER_QUEUED || added == SCHEDULER_DELAYED) return 1;
+    free(task.prefix);
+    free(task.suffix);
+    return 0;
+}
+
+// As GetFromQueue: sleeps until the timer wheel next has something due. Returns 0 once
+// the queue is closed and empty.
+static int GetFromQueue(QueuedTask* task) {
+    int taken = 0;
+    pthread_mutex_lock(&g_queueLock);
+    for (;;) {
+        unsigned long long timeoutMs;
+        SchedulerWake wake;
+        int groupIndex = SchedulerTake(&g_scheduler, TickMs(), task, &timeoutMs, &wake);
+        WakeWorkers(wake);
+        if (groupIndex >= 0) {
+            pthread_cond_signal(&g_queueNotFull);
+            taken = 1;
+            break;
+        }
+        const TaskGroup* group = &g_scheduler.groups[0];
+        if (g_queueClosed && group->count == 0 && group->delayed_count == 0) break;
+
+        if (timeoutMs == TIMER_WHEEL_IDLE) {
+            pthread_cond_wait(&g_queueNotEmpty, &g_queueLock);
+        } else {
+            struct timespec until;
+            clock_gettime(CLOCK_MONOTONIC, &until);
+            until.tv_sec += (time_t)(timeoutMs / 1000);
+            until.tv_nsec += (long)(timeoutMs % 1000) * 1000000;
+            if (until.tv_nsec >= 1000000000) { until.tv_sec++; until.tv_nsec -= 1000000000; }
+            pthread_cond_timedwait(&g_queueNotEmpty, &g_queueLock, &until);
+        }
+    }
+    pthread_mutex_unlock(&g_queueLock);
+    return taken;
+}
+
+static void CompleteTask(int groupIndex) {
+    pthread_mutex_lock(&g_queueLock);
+    WakeWorkers(SchedulerComplete(&g_scheduler, groupIndex));
+    pthread_mutex_unlock(&g_queueLock);
+}
+
+// Starts the child with stdout and stderr on their own pipes and stdin on /dev/null, as
+// LaunchChildProcess does. The pipes are close-on-exec, so a child started by another
+// worker at the same time does not hold this one's write ends open.
+static int LaunchChildProcess(pid_t* pid, int* outRead, int* errRead) {
+    int out[2], err[2];
+    if (pipe2(out, O_CLOEXEC) != 0) return 0;
+    if (pipe2(err, O_CLOEXEC) != 0) {
+        close(out[0]);
+        close(out[1]);
+        return 0;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, out[1], 1);
+    posix_spawn_file_actions_adddup2(&actions, err[1], 2);
+    int rc = posix_spawn(pid, g_childArgv[0], &actions, NULL, g_childArgv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(out[1]);
+    close(err[1]);
+    if (rc != 0) {
+        close(out[0]);
+        close(err[0]);
+        return 0;
+    }
+    *outRead = out[0];
+    *errRead = err[0];
+    return 1;
+}
+
+static void RecordLatency(double seconds) {
+    pthread_mutex_lock(&g_latencyLock);
+    g_latencies[g_latencyCount++] = seconds;
+    pthread_mutex_unlock(&g_latencyLock);
+}
+
+static void* CommandProcessorThread(void* arg) {
+    (void)arg;
+    for (;;) {
+        double freeSec = NowSec();
+        QueuedTask task;
+        if (!GetFromQueue(&task)) break;
+        int taskNumber = (int)wcstol(task.suffix, NULL, 10);
+        double readySec = g_enqueuedSec[taskNumber] > freeSec ? g_enqueuedSec[taskNumber] : freeSec;
+
+        TaskLogTag logTag;
+        logTag.task_id = __atomic_add_fetch(&g_lastLogTaskId, 1, __ATOMIC_RELAXED);
+        snprintf(logTag.tag, sizeof(logTag.tag), "[bench #%ld]", logTag.task_id);
+        char cmdMsg[1024];
+        int used = snprintf(cmdMsg, sizeof(cmdMsg), "$");
+        for (char** a = g_childArgv; *a && used < (int)sizeof(cmdMsg); ++a) {
+            used += snprintf(cmdMsg + used, sizeof(cmdMsg) - (size_t)used, " %s", *a);
+        }
+        PostTaskLogLine(&logTag, cmdMsg, 0, 0);
+
+        pid_t pid;
+        int outRead, errRead;
+        if (LaunchChildProcess(&pid, &outRead, &errRead)) {
+            RecordLatency(NowSec() - readySec);
+            TaskLog taskLog;
+            pthread_mutex_init(&taskLog.lock, NULL);
+            taskLog.tag = &logTag;
+            TaskLogBudgetInit(&taskLog.budget, TickMs());
+            PipeReaderContext outCtx = { outRead, 0, &taskLog };
+            PipeReaderContext errCtx = { errRead, 1, &taskLog };
+            pthread_t outReader, errReader;
+            int outStarted = pthread_create(&outReader, NULL, PipeReaderThread, &outCtx) == 0;
+            int errStarted = pthread_create(&errReader, NULL, PipeReaderThread, &errCtx) == 0;
+
+            int status = 0;
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+            if (outStarted) pthread_join(outReader, NULL);
+            if (errStarted) pthread_join(errReader, NULL);
+            FlushTaskLog(&taskLog);
+            __atomic_add_fetch(&g_linesDropped, (long long)taskLog.budget.suppressed_lines_total, __ATOMIC_RELAXED);
+
+            char exitMsg[256];
+            snprintf(exitMsg, sizeof(exitMsg), "Process finished. Exit code: %d (%llu lines, %llu bytes)",
+                     WIFEXITED(status) ? WEXITSTATUS(status) : -1,
+                     taskLog.budget.lines_total, taskLog.budget.bytes_total);
+            PostTaskLogLine(&logTag, exitMsg, 0, 0);
+            TaskLogBudgetFree(&taskLog.budget);
+            pthread_mutex_destroy(&taskLog.lock);
+            close(outRead);
+            close(errRead);
+        } else {
+            __atomic_add_fetch(&g_readErrors, 1, __ATOMIC_RELAXED);
+            PostTaskLogLine(&logTag, "Error starting command", 0, 0);
+        }
+
+        CompleteTask(task.group_index);
+        free(task.prefix);
+        free(task.suffix);
+    }
+    return NULL;
+}
+
+// --- Results ---
+static double CpuSec(int who) {
+    struct rusage ru;
+    getrusage(who, &ru);
+    return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) + (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static int CompareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank below, as cmd-queue-bench's percentileMs.
+static double PercentileMs(const double* sorted, int count, double p) {
+    if (count == 0) return 0;
+    return sorted[(int)((double)(count - 1) * p)] * 1000.0;
+}
+
+// --- Entry Point ---
+int main(int argc, char** argv) {
+    if (argc < 3 || atoi(argv[1]) < 1) {
+        fprintf(stderr, "usage: engine_bench <tasks> <child argv...>\n");
+        return 2;
+    }
+    int tasks = atoi(argv[1]);
+    g_childArgv = argv + 2;
+    g_enqueuedSec = (double*)calloc((size_t)tasks, sizeof(double));
+    g_latencies = (double*)calloc((size_t)tasks, sizeof(double));
+    if (!g_enqueuedSec || !g_latencies) return 1;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_queueNotEmpty, &attr);
+    pthread_cond_init(&g_queueNotFull, &attr);
+    pthread_condattr_destroy(&attr);
+
+    double cpuStart = CpuSec(RUSAGE_SELF), childStart = CpuSec(RUSAGE_CHILDREN);
+    SchedulerInit(&g_scheduler, TIMER_TICK_MS, TickMs());
+    TaskGroup* group = SchedulerAddGroup(&g_scheduler, GROUP_MAX_RUNNING, TickMs());
+    wcscpy(group->name, L"bench");
+
+    double start = NowSec();
+    pthread_t ui, workers[WORKER_THREAD_COUNT];
+    pthread_create(&ui, NULL, UIThread, NULL);
+    for (int i = 0; i < WORKER_THREAD_COUNT; ++i) pthread_create(&workers[i], NULL, CommandProcessorThread, NULL);
+    for (int i = 0; i < tasks; ++i) {
+        if (!AddToQueue(i)) __atomic_add_fetch(&g_readErrors, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_lock(&g_queueLock);
+    g_queueClosed = 1;
+    pthread_cond_broadcast(&g_queueNotEmpty);
+    pthread_mutex_unlock(&g_queueLock);
+    for (int i = 0; i < WORKER_THREAD_COUNT; ++i) pthread_join(workers[i], NULL);
+
+    pthread_mutex_lock(&g_messageLock);
+    g_uiExiting = 1;
+    pthread_cond_signal(&g_messageReady);
+    pthread_mutex_unlock(&g_messageLock);
+    pthread_join(ui, NULL);
+    double wall = NowSec() - start;
+
+    double cpu = CpuSec(RUSAGE_SELF) - cpuStart, childCpu = CpuSec(RUSAGE_CHILDREN) - childStart;
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    qsort(g_latencies, (size_t)g_latencyCount, sizeof(double), CompareDoubles);
+    printf("{\"tasks\":%d,\"wall_s\":%.6f,\"dispatch_p50_ms\":%.3f,\"dispatch_p99_ms\":%.3f,\"dispatch_max_ms\":%.3f,"
+           "\"lines_read\":%lld,\"lines_shown\":%lld,\"lines_dropped\":%lld,\"read_lines_per_s\":%.1f,\"shown_lines_per_s\":%.1f,"
+           "\"ui_bytes\":%lld,\"read_errors\":%lld,\"cpu_s\":%.3f,\"child_cpu_s\":%.3f,\"peak_rss_mb\":%.1f}\n",
+           tasks, wall,
+           PercentileMs(g_latencies, g_latencyCount, 0.50), PercentileMs(g_latencies, g_latencyCount, 0.99),
+           PercentileMs(g_latencies, g_latencyCount, 1.0),
+           g_linesRead, g_linesShown, g_linesDropped, (double)g_linesRead / wall, (double)g_linesShown / wall,
+           g_uiBytes, g_readErrors, cpu, childCpu, (double)ru.ru_maxrss / 1024); // ru_maxrss is in KB on Linux
+
+    SchedulerFree(&g_scheduler);
+    free(g_enqueuedSec);
+    free(g_latencies);
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "export.h"
+
+#define UTF8_MAX_BYTES 4
+#define REPLACEMENT_CHARACTER 0xFFFD
+
+void ExportWriterInit(ExportWriter* w, ExportWriteFn write, void* context, char* buffer, size_t bufferSize,
+                      unsigned long long snapshotUnixMs) {
+    w->write = write;
+    w->context = context;
+    w->buffer = buffer;
+    w->buffer_size = bufferSize;
+    w->used = 0;
+    w->failed = 0;
+    w->snapshot_unix_ms = snapshotUnixMs;
+}
+
+int ExportFlush(ExportWriter* w) {
+    if (w->used > 0 && !w->failed && !w->write(w->context, w->buffer, w->used)) w->failed = 1;
+    w->used = 0;
+    return !w->failed;
+}
+
+static void ExportPut(ExportWriter* w, const char* data, size_t len) {
+    if (w->used + len > w->buffer_size) ExportFlush(w);
+    if (len > w->buffer_size) { // Never happens for a single field, but stay correct
+        if (!w->failed && !w->write(w->context, data, len)) w->failed = 1;
+        return;
+    }
+    memcpy(w->buffer + w->used, data, len);
+    w->used += len;
+}
+
+static void ExportPrintf(ExportWriter* w, const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (len > 0) ExportPut(w, line, (size_t)len < sizeof(line) ? (size_t)len : sizeof(line) - 1);
+}
+
+// ",value", or just "," when the value is unknown (0).
+static void ExportCsvOptional(ExportWriter* w, unsigned long long value) {
+    if (value) ExportPrintf(w, ",%llu", value);
+    else ExportPut(w, ",", 1);
+}
+
+// Reads one code point, joining UTF-16 surrogate pairs where wchar_t is 16 bits wide.
+// Unpaired surrogates become U+FFFD so the output is always valid UTF-8.
+static unsigned long NextCodePoint(const wchar_t** text) {
+    unsigned long c = (unsigned long)**text;
+    (*text)++;
+    if (c >= 0xD800 && c <= 0xDBFF) {
+        unsigned long low = (unsigned long)**text;
+        if (low >= 0xDC00 && low <= 0xDFFF) {
+            (*text)++;
+            return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+        }
+        return REPLACEMENT_CHARACTER;
+    }
+    if ((c >= 0xDC00 && c <= 0xDFFF) || c > 0x10FFFF) return REPLACEMENT_CHARACTER;
+    return c;
+}
+
+// Appends c as UTF-8; the caller has made room for UTF8_MAX_BYTES.
+static void PutUtf8(ExportWriter* w, unsigned long c) {
+    char* out = w->buffer + w->used;
+    if (c < 0x80) {
+        out[0] = (char)c;
+        w->used += 1;
+    } else if (c < 0x800) {
+        out[0] = (char)(0xC0 | (c >> 6));
+        out[1] = (char)(0x80 | (c & 0x3F));
+        w->used += 2;
+    } else if (c < 0x10000) {
+        out[0] = (char)(0xE0 | (c >> 12));
+        out[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (c & 0x3F));
+        w->used += 3;
+    } else {
+        out[0] = (char)(0xF0 | (c >> 18));
+        out[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (c & 0x3F));
+        w->used += 4;
+    }
+}
+
+// Quoted CSV field; embedded quotes are doubled, commas and line breaks kept as they are.
+static void ExportCsvString(ExportWriter* w, const wchar_t* text) {
+    ExportPut(w, "\"", 1);
+    while (text && *text) {
+        unsigned long c = NextCodePoint(&text);
+        if (w->used + 2 * UTF8_MAX_BYTES > w->buffer_size) ExportFlush(w);
+        if (c == '"') w->buffer[w->used++] = '"';
+        PutUtf8(w, c);
+    }
+    ExportPut(w, "\"", 1);
+}
+
+static void ExportJsonString(ExportWriter* w, const wchar_t* text) {
+    ExportPut(w, "\"", 1);
+    while (text && *text) {
+        unsigned long c = NextCodePoint(&text);
+        if (c == '"' || c == '\\') {
+            char escaped[2] = { '\\', (char)c };
+            ExportPut(w, escaped, 2);
+        } else if (c < 0x20) {
+            ExportPrintf(w, "\\u%04lx", c);
+        } else {
+            if (w->used + UTF8_MAX_BYTES > w->buffer_size) ExportFlush(w);
+            PutUtf8(w, c);
+        }
+    }
+    ExportPut(w, "\"", 1);
+}
+
+const char* TaskRecordState(const TaskRecord* r, unsigned long long snapshotUnixMs) {
+    if (r->finished_unix_ms == 0) {
+        if (r->started_unix_ms) return "running";
+        return r->not_before_unix_ms > snapshotUnixMs ? "scheduled" : "queued";
+    }
+    if (!r->started) return "start_failed";
+    return r->exit_code == 0 ? "ok" : "failed";
+}
+
+void ExportCsvHeader(ExportWriter* w) {
+    ExportPrintf(w, "id,state,group,profile,command,enqueued_unix_ms,not_before_unix_ms,started_unix_ms,"
+                    "finished_unix_ms,launch_ms,run_s,exit_code,bytes,lines,suppressed_lines\r\n");
+}
+
+// Columns a task does not have yet (a pending task's start, a running task's results) are
+// left empty rather than 0.
+void ExportCsvRecord(ExportWriter* w, const TaskRecord* r, const wchar_t* groupName, const wchar_t* profileName) {
+    if (r->id) ExportPrintf(w, "%llu", r->id);
+    ExportPrintf(w, ",%s,", TaskRecordState(r, w->snapshot_unix_ms));
+    ExportCsvString(w, groupName);
+    ExportPut(w, ",", 1);
+    ExportCsvString(w, profileName);
+    ExportPut(w, ",", 1);
+    ExportCsvString(w, r->command);
+    ExportCsvOptional(w, r->enqueued_unix_ms);
+    ExportCsvOptional(w, r->not_before_unix_ms);
+    ExportCsvOptional(w, r->started_unix_ms);
+    if (r->finished_unix_ms == 0) {
+        ExportPut(w, ",,,,,,,\r\n", 9);
+    } else {
+        ExportPrintf(w, ",%llu,%.3f,%.3f,%lu,%llu,%llu,%llu\r\n",
+                     r->finished_unix_ms, r->launch_ms, r->run_seconds, r->exit_code,
+                     r->bytes_out, r->lines_out, r->lines_suppressed);
+    }
+}
+
+void ExportJsonHeader(ExportWriter* w, size_t finished, size_t running, size_t pending) {
+    ExportPrintf(w, "{\"snapshot_unix_ms\":%llu,\"history\":%zu,\"running\":%zu,\"pending\":%zu}\n",
+                 w->snapshot_unix_ms, finished, running, pending);
+}
+
+// Same fields as the CSV; ones a task does not have yet are omitted.
+void ExportJsonRecord(ExportWriter* w, const TaskRecord* r, const wchar_t* groupName, const wchar_t* profileName) {
+    ExportPut(w, "{", 1);
+    if (r->id) ExportPrintf(w, "\"id\":%llu,", r->id);
+    ExportPrintf(w, "\"state\":\"%s\",\"group\":", TaskRecordState(r, w->snapshot_unix_ms));
+    ExportJsonString(w, groupName);
+    ExportPut(w, ",\"profile\":", 11);
+    ExportJsonString(w, profileName);
+    ExportPut(w, ",\"command\":", 11);
+    ExportJsonString(w, r->command);
+    ExportPrintf(w, ",\"enqueued\":%llu", r->enqueued_unix_ms);
+    if (r->not_before_unix_ms) ExportPrintf(w, ",\"not_before\":%llu", r->not_before_unix_ms);
+    if (r->started_unix_ms) ExportPrintf(w, ",\"started\":%llu", r->started_unix_ms);
+    if (r->finished_unix_ms) {
+        ExportPrintf(w, ",\"finished\":%llu,\"launch_ms\":%.3f,\"run_s\":%.3f,\"exit_code\":%lu,"
+                        "\"bytes\":%llu,\"lines\":%llu,\"suppressed\":%llu",
+                     r->finished_unix_ms, r->launch_ms, r->run_seconds, r->exit_code,
+                     r->bytes_out, r->lines_out, r->lines_suppressed);
+    }
+    ExportPut(w, "}\n", 2);
+}
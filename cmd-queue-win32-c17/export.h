@@ -0,0 +1,56 @@
+// CSV and JSON-lines formatting for the queue/history export. Plain C with no Win32
+// dependency; output goes through a caller-supplied write function, so the formatting
+// can be tested and timed on any platform.
+#ifndef CMDQ_EXPORT_H
+#define CMDQ_EXPORT_H
+
+#include <stddef.h>
+#include <wchar.h>
+
+// One task as exported. Finished tasks are immutable once appended to the run history;
+// queued, scheduled and running tasks use the same record with finished_unix_ms == 0.
+typedef struct {
+    unsigned long long id;              // Completion order, from 1; 0 until finished
+    int group_index;
+    int profile_index;
+    wchar_t* command;
+    unsigned long long enqueued_unix_ms;
+    unsigned long long not_before_unix_ms; // Scheduled start, 0 for none
+    unsigned long long started_unix_ms;    // 0 while still waiting
+    unsigned long long finished_unix_ms;   // 0 while queued, scheduled or running
+    double launch_ms;
+    double run_seconds;
+    int started;                        // FALSE if the process could not be created
+    unsigned long exit_code;            // Process exit code, or the launch error when not started
+    unsigned long long bytes_out;
+    unsigned long long lines_out;
+    unsigned long long lines_suppressed; // Counted but kept out of the log by the task's budget
+} TaskRecord;
+
+// Returns nonzero on success.
+typedef int (*ExportWriteFn)(void* context, const char* data, size_t len);
+
+// Buffers output and hands it to write in buffer_size pieces (at least 16 bytes).
+typedef struct {
+    ExportWriteFn write;
+    void* context;
+    char* buffer;
+    size_t buffer_size;
+    size_t used;
+    int failed;
+    unsigned long long snapshot_unix_ms; // When the tasks were copied; later not-before times are "scheduled"
+} ExportWriter;
+
+void ExportWriterInit(ExportWriter* w, ExportWriteFn write, void* context, char* buffer, size_t bufferSize,
+                      unsigned long long snapshotUnixMs);
+int ExportFlush(ExportWriter* w); // Returns nonzero if everything so far was written
+
+// "queued", "scheduled", "running", "ok", "failed" or "start_failed".
+const char* TaskRecordState(const TaskRecord* r, unsigned long long snapshotUnixMs);
+
+void ExportCsvHeader(ExportWriter* w);
+void ExportCsvRecord(ExportWriter* w, const TaskRecord* r, const wchar_t* groupName, const wchar_t* profileName);
+void ExportJsonHeader(ExportWriter* w, size_t finished, size_t running, size_t pending);
+void ExportJsonRecord(ExportWriter* w, const TaskRecord* r, const wchar_t* groupName, const wchar_t* profileName);
+
+#endif // CMDQ_EXPORT_H
@@ -0,0 +1,225 @@
+// Host-built checks for export.c, including how long 100k records take (make test).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "export.h"
+
+#define SNAPSHOT_MS      1700000000000ULL
+#define BENCH_RECORDS    100000
+#define BENCH_BUDGET_MS  1000.0 // The export target for 100k finished tasks, formatting both files
+
+static int g_checks = 0;
+static int g_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    g_checks++; \
+    if (!(cond)) { \
+        g_failures++; \
+        fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, #cond); \
+        fprintf(stderr, __VA_ARGS__); \
+        fputc('\n', stderr); \
+    } \
+} while (0)
+
+// In-memory sink; a small writer buffer makes sure flushing mid-string works.
+typedef struct {
+    char data[4096];
+    size_t len;
+    size_t writes;
+} Sink;
+
+static int SinkWrite(void* context, const char* data, size_t len) {
+    Sink* sink = (Sink*)context;
+    if (sink->len + len >= sizeof(sink->data)) return 0;
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+    sink->data[sink->len] = '\0';
+    sink->writes++;
+    return 1;
+}
+
+static size_t g_benchBytes = 0;
+static int CountWrite(void* context, const char* data, size_t len) {
+    (void)context;
+    (void)data;
+    g_benchBytes += len;
+    return 1;
+}
+
+static const char* Format(int json, const TaskRecord* r, const wchar_t* group, const wchar_t* profile) {
+    static Sink sink;
+    static char buffer[16];
+    sink.len = 0;
+    sink.data[0] = '\0';
+    ExportWriter w;
+    ExportWriterInit(&w, SinkWrite, &sink, buffer, sizeof(buffer), SNAPSHOT_MS);
+    if (json) ExportJsonRecord(&w, r, group, profile);
+    else ExportCsvRecord(&w, r, group, profile);
+    CHECK(ExportFlush(&w), "write failed");
+    return sink.data;
+}
+
+#define CHECK_OUTPUT(actual, expected) do { \
+    const char* a_ = (actual); \
+    CHECK(strcmp(a_, expected) == 0, "got\n  %s\nexpected\n  %s", a_, expected); \
+} while (0)
+
+static TaskRecord FinishedRecord(void) {
+    TaskRecord r = {0};
+    r.id = 7;
+    r.command = L"yt-dlp -f 140 abc";
+    r.enqueued_unix_ms = SNAPSHOT_MS - 5000;
+    r.started_unix_ms = SNAPSHOT_MS - 4000;
+    r.finished_unix_ms = SNAPSHOT_MS - 1000;
+    r.launch_ms = 1.25;
+    r.run_seconds = 2.5;
+    r.started = 1;
+    r.bytes_out = 1024;
+    r.lines_out = 10;
+    return r;
+}
+
+static int CountFields(const char* csvLine) {
+    int fields = 1, quoted = 0;
+    for (const char* p = csvLine; *p && (quoted || (*p != '\r' && *p != '\n')); ++p) {
+        if (*p == '"') quoted = !quoted;
+        else if (*p == ',' && !quoted) fields++;
+    }
+    return fields;
+}
+
+static void TestCsv(void) {
+    static Sink sink;
+    static char buffer[64];
+    ExportWriter w;
+    ExportWriterInit(&w, SinkWrite, &sink, buffer, sizeof(buffer), SNAPSHOT_MS);
+    ExportCsvHeader(&w);
+    ExportFlush(&w);
+    CHECK(CountFields(sink.data) == 15, "header has %d columns", CountFields(sink.data));
+    CHECK(strstr(sink.data, ",not_before_unix_ms,started_unix_ms,") != NULL, "header: %s", sink.data);
+
+    TaskRecord r = FinishedRecord();
+    CHECK_OUTPUT(Format(0, &r, L"Audio", L"Default"),
+                 "7,ok,\"Audio\",\"Default\",\"yt-dlp -f 140 abc\",1699999995000,,1699999996000,"
+                 "1699999999000,1.250,2.500,0,1024,10,0\r\n");
+
+    r.command = L"say \"hi\", then\r\nbye";
+    r.exit_code = 2;
+    const char* line = Format(0, &r, L"a,b", L"Default");
+    CHECK(strstr(line, ",failed,\"a,b\",") != NULL, "%s", line);
+    CHECK(strstr(line, ",\"say \"\"hi\"\", then\r\nbye\",") != NULL, "%s", line);
+    CHECK(CountFields(line) == 15, "%d fields in %s", CountFields(line), line);
+
+    r.started = 0;
+    r.exit_code = 2;
+    CHECK(strstr(Format(0, &r, L"g", L"p"), ",start_failed,") != NULL, "not started");
+}
+
+static void TestPendingAndRunning(void) {
+    TaskRecord r = {0};
+    r.command = L"cmd";
+    r.enqueued_unix_ms = SNAPSHOT_MS - 10;
+    CHECK_OUTPUT(Format(0, &r, L"g", L"p"), ",queued,\"g\",\"p\",\"cmd\",1699999999990,,,,,,,,,\r\n");
+    CHECK_OUTPUT(Format(1, &r, L"g", L"p"),
+                 "{\"state\":\"queued\",\"group\":\"g\",\"profile\":\"p\",\"command\":\"cmd\",\"enqueued\":1699999999990}\n");
+
+    r.not_before_unix_ms = SNAPSHOT_MS + 60000;
+    CHECK_OUTPUT(Format(0, &r, L"g", L"p"), ",scheduled,\"g\",\"p\",\"cmd\",1699999999990,1700000060000,,,,,,,,\r\n");
+    CHECK(strstr(Format(1, &r, L"g", L"p"), "\"state\":\"scheduled\"") != NULL, "scheduled json");
+    CHECK(strstr(Format(1, &r, L"g", L"p"), ",\"not_before\":1700000060000}") != NULL, "not_before json");
+
+    r.not_before_unix_ms = SNAPSHOT_MS - 5; // Due, waiting in its group's queue
+    CHECK(strstr(Format(0, &r, L"g", L"p"), ",queued,") != NULL, "due task");
+
+    r.started_unix_ms = SNAPSHOT_MS - 1;
+    CHECK_OUTPUT(Format(0, &r, L"g", L"p"),
+                 ",running,\"g\",\"p\",\"cmd\",1699999999990,1699999999995,1699999999999,,,,,,,\r\n");
+    CHECK(strstr(Format(1, &r, L"g", L"p"), "\"state\":\"running\"") != NULL, "running json");
+    CHECK(strstr(Format(1, &r, L"g", L"p"), "\"finished\"") == NULL, "running has no results");
+}
+
+static void TestJsonAndUtf8(void) {
+    TaskRecord r = FinishedRecord();
+    CHECK_OUTPUT(Format(1, &r, L"Audio", L"Default"),
+                 "{\"id\":7,\"state\":\"ok\",\"group\":\"Audio\",\"profile\":\"Default\",\"command\":\"yt-dlp -f 140 abc\","
+                 "\"enqueued\":1699999995000,\"started\":1699999996000,\"finished\":1699999999000,\"launch_ms\":1.250,"
+                 "\"run_s\":2.500,\"exit_code\":0,\"bytes\":1024,\"lines\":10,\"suppressed\":0}\n");
+
+    r.command = L"a\"b\\c\td\n";
+    CHECK(strstr(Format(1, &r, L"g", L"p"), "\"command\":\"a\\\"b\\\\c\\u0009d\\u000a\"") != NULL,
+          "%s", Format(1, &r, L"g", L"p"));
+
+    // é is two UTF-8 bytes and the emoji four, whether wchar_t holds it whole or as a surrogate pair.
+    r.command = L"café \U0001F600";
+    CHECK(strstr(Format(1, &r, L"g", L"p"), "\"caf\xC3\xA9 \xF0\x9F\x98\x80\"") != NULL, "json utf-8");
+    CHECK(strstr(Format(0, &r, L"g", L"p"), "\"caf\xC3\xA9 \xF0\x9F\x98\x80\"") != NULL, "csv utf-8");
+
+    static const wchar_t lone[] = { L'x', (wchar_t)0xD800, L'y', 0 };
+    r.command = (wchar_t*)lone;
+    CHECK(strstr(Format(1, &r, L"g", L"p"), "\"x\xEF\xBF\xBDy\"") != NULL, "lone surrogate");
+}
+
+static void TestWriteFailure(void) {
+    static Sink sink;
+    static char buffer[16];
+    memset(&sink, 0, sizeof(sink));
+    sink.len = sizeof(sink.data) - 8; // Nearly full: the first flush fails
+    ExportWriter w;
+    ExportWriterInit(&w, SinkWrite, &sink, buffer, sizeof(buffer), SNAPSHOT_MS);
+    TaskRecord r = FinishedRecord();
+    ExportCsvRecord(&w, &r, L"g", L"p");
+    CHECK(!ExportFlush(&w), "failed write not reported");
+}
+
+static double NowMs(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+// Both files for BENCH_RECORDS finished tasks, through the 1 MB buffer main.c uses.
+static void TestHundredThousandRecords(void) {
+    TaskRecord* records = (TaskRecord*)calloc(BENCH_RECORDS, sizeof(TaskRecord));
+    char* buffer = (char*)malloc(1 << 20);
+    CHECK(records && buffer, "out of memory");
+    if (!records || !buffer) return;
+    for (int i = 0; i < BENCH_RECORDS; ++i) {
+        records[i] = FinishedRecord();
+        records[i].id = (unsigned long long)i + 1;
+        records[i].command = L"yt-dlp --js-runtimes quickjs --cookies cookies.txt -f 140 -N 12 "
+                             L"https://www.youtube.com/watch?v=dQw4w9WgXcQ";
+        records[i].exit_code = (unsigned long)(i % 7 == 0);
+    }
+
+    double start = NowMs();
+    for (int json = 0; json < 2; ++json) {
+        ExportWriter w;
+        ExportWriterInit(&w, CountWrite, NULL, buffer, 1 << 20, SNAPSHOT_MS);
+        if (json) ExportJsonHeader(&w, BENCH_RECORDS, 0, 0);
+        else ExportCsvHeader(&w);
+        for (int i = 0; i < BENCH_RECORDS; ++i) {
+            if (json) ExportJsonRecord(&w, &records[i], L"Audio", L"Default");
+            else ExportCsvRecord(&w, &records[i], L"Audio", L"Default");
+        }
+        CHECK(ExportFlush(&w), "write failed");
+    }
+    double elapsed = NowMs() - start;
+    printf("export_test: %d records to CSV and JSON lines (%zu bytes) in %.1f ms\n",
+           BENCH_RECORDS, g_benchBytes, elapsed);
+    CHECK(elapsed < BENCH_BUDGET_MS, "took %.1f ms, budget %.0f ms", elapsed, BENCH_BUDGET_MS);
+
+    free(records);
+    free(buffer);
+}
+
+int main(void) {
+    TestCsv();
+    TestPendingAndRunning();
+    TestJsonAndUtf8();
+    TestWriteFailure();
+    TestHundredThousandRecords();
+    printf("export_test: %d checks, %d failed\n", g_checks, g_failures);
+    return g_failures ? 1 : 0;
+}
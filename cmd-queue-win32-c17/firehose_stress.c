@@ -0,0 +1,139 @@
+// Stress test: does the window stay responsive while tasks flood it with output?
+//
+//   firehose_stress.exe [path\to\cmd_queue_win32.exe] [seconds]
+//
+// Starts the app, queues two copies of this program in --emit mode (lines as fast as the
+// pipe takes them, progress updates and over-long lines without a newline) and meanwhile
+// pings the window with WM_NULL every PROBE_INTERVAL_MS. Fails if any ping takes longer
+// than MAX_PING_MS or the app does not exit cleanly afterwards.
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+// Must match main.c
+#define WINDOW_CLASS_NAME L"CmdQueueGUIWindowClass"
+#define IDC_EDIT_PREFIX   101
+#define IDC_EDIT_INPUT    107
+#define IDC_BUTTON_ADD    108
+
+#define EMITTER_COUNT      2   // Audio group default cap, so both run at once
+#define DEFAULT_SECONDS    10
+#define PROBE_INTERVAL_MS  20
+#define MAX_PING_MS        250
+#define MAX_PROBES         4096
+
+// --- Emitter (runs as the queued task) ---
+static int Emit(int seconds) {
+    static char line[160];
+    static char longLine[20000]; // Several pipe buffers without a newline
+    memset(longLine, 'y', sizeof(longLine));
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    ULONGLONG end = GetTickCount64() + (ULONGLONG)seconds * 1000;
+    DWORD written;
+    for (unsigned long i = 0; GetTickCount64() < end; ++i) {
+        int len;
+        if (i % 1000 == 999) {
+            if (!WriteFile(out, longLine, sizeof(longLine), &written, NULL)) return 1;
+            len = snprintf(line, sizeof(line), "\n");
+        } else if (i % 10 == 0) {
+            len = snprintf(line, sizeof(line), "[download] %5.1f%% of firehose\r", (double)(i % 1000) / 10.0);
+        } else {
+            len = snprintf(line, sizeof(line), "line %08lu xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\n", i);
+        }
+        if (!WriteFile(out, line, (DWORD)len, &written, NULL)) return 1; // App closed the pipe
+    }
+    return 0;
+}
+
+// --- Driver ---
+static int CompareDouble(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static HWND WaitForAppWindow(DWORD processId, DWORD timeoutMs) {
+    ULONGLONG deadline = GetTickCount64() + timeoutMs;
+    while (GetTickCount64() < deadline) {
+        HWND hwnd = NULL;
+        while ((hwnd = FindWindowExW(NULL, hwnd, WINDOW_CLASS_NAME, NULL)) != NULL) {
+            DWORD owner = 0;
+            GetWindowThreadProcessId(hwnd, &owner);
+            if (owner == processId) return hwnd;
+        }
+        Sleep(50);
+    }
+    return NULL;
+}
+
+int wmain(int argc, wchar_t** argv) {
+    if (argc >= 3 && wcscmp(argv[1], L"--emit") == 0) return Emit(_wtoi(argv[2]));
+
+    const wchar_t* appPath = argc >= 2 ? argv[1] : L"cmd_queue_win32.exe";
+    int seconds = argc >= 3 ? _wtoi(argv[2]) : DEFAULT_SECONDS;
+    if (seconds <= 0) seconds = DEFAULT_SECONDS;
+
+    wchar_t selfPath[MAX_PATH];
+    GetModuleFileNameW(NULL, selfPath, MAX_PATH);
+
+    wchar_t cmdLine[MAX_PATH + 16];
+    swprintf(cmdLine, sizeof(cmdLine)/sizeof(wchar_t), L"\"%s\"", appPath);
+    STARTUPINFOW si = {0};
+    si.cb = sizeof(si);
+    PROCESS_INFORMATION pi = {0};
+    if (!CreateProcessW(NULL, cmdLine, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi)) {
+        fwprintf(stderr, L"FAIL: cannot start %s (Code: %lu)\n", appPath, GetLastError());
+        return 1;
+    }
+    HWND hwnd = WaitForAppWindow(pi.dwProcessId, 10000);
+    if (!hwnd) {
+        fwprintf(stderr, L"FAIL: no app window after 10 s\n");
+        TerminateProcess(pi.hProcess, 1);
+        return 1;
+    }
+
+    // Queue the emitters the way a user would: prefix, suffix, Add.
+    wchar_t prefix[MAX_PATH + 16], suffix[16];
+    swprintf(prefix, sizeof(prefix)/sizeof(wchar_t), L"\"%s\" --emit", selfPath);
+    swprintf(suffix, sizeof(suffix)/sizeof(wchar_t), L"%d", seconds);
+    SendMessageW(GetDlgItem(hwnd, IDC_EDIT_PREFIX), WM_SETTEXT, 0, (LPARAM)prefix);
+    for (int i = 0; i < EMITTER_COUNT; ++i) {
+        SendMessageW(GetDlgItem(hwnd, IDC_EDIT_INPUT), WM_SETTEXT, 0, (LPARAM)suffix);
+        SendMessageW(GetDlgItem(hwnd, IDC_BUTTON_ADD), BM_CLICK, 0, 0);
+    }
+
+    static double pings[MAX_PROBES];
+    int probeCount = 0, hung = 0;
+    LARGE_INTEGER freq, t0, t1;
+    QueryPerformanceFrequency(&freq);
+    ULONGLONG end = GetTickCount64() + (ULONGLONG)(seconds + 2) * 1000;
+    while (GetTickCount64() < end && probeCount < MAX_PROBES) {
+        DWORD_PTR result;
+        QueryPerformanceCounter(&t0);
+        if (!SendMessageTimeoutW(hwnd, WM_NULL, 0, 0, SMTO_NORMAL, 5000, &result)) hung++;
+        QueryPerformanceCounter(&t1);
+        pings[probeCount++] = (double)(t1.QuadPart - t0.QuadPart) * 1000.0 / (double)freq.QuadPart;
+        Sleep(PROBE_INTERVAL_MS);
+    }
+
+    qsort(pings, probeCount, sizeof(double), CompareDouble);
+    double p50 = probeCount ? pings[probeCount / 2] : 0.0;
+    double p99 = probeCount ? pings[(probeCount - 1) * 99 / 100] : 0.0;
+    double worst = probeCount ? pings[probeCount - 1] : 0.0;
+    wprintf(L"%d pings: p50 %.2f ms, p99 %.2f ms, max %.2f ms, %d timed out\n", probeCount, p50, p99, worst, hung);
+
+    // The emitters are done by now, so the app should close promptly.
+    PostMessageW(hwnd, WM_CLOSE, 0, 0);
+    BOOL exited = WaitForSingleObject(pi.hProcess, 15000) == WAIT_OBJECT_0;
+    if (!exited) TerminateProcess(pi.hProcess, 1);
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+
+    if (hung || worst > MAX_PING_MS || !exited) {
+        fwprintf(stderr, L"FAIL: %s\n", !exited ? L"app did not exit" : L"window unresponsive under output flood");
+        return 1;
+    }
+    wprintf(L"PASS\n");
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <stdlib.h>
+
+#include "launcher.h"
+
+BOOL InitProcessLauncher(ProcessLauncher* launcher, HANDLE nulInput) {
+    launcher->attr_list = NULL;
+    launcher->attr_list_size = 0;
+    launcher->nul_input = nulInput;
+    // First call only reports the required size and "fails" with ERROR_INSUFFICIENT_BUFFER.
+    InitializeProcThreadAttributeList(NULL, 1, 0, &launcher->attr_list_size);
+    if (launcher->attr_list_size == 0) return FALSE;
+    launcher->attr_list = (LPPROC_THREAD_ATTRIBUTE_LIST)malloc(launcher->attr_list_size);
+    return launcher->attr_list != NULL;
+}
+
+void FreeProcessLauncher(ProcessLauncher* launcher) {
+    free(launcher->attr_list);
+    launcher->attr_list = NULL;
+}
+
+// Only the two pipe write ends and the shared NUL stdin are inherited:
+// PROC_THREAD_ATTRIBUTE_HANDLE_LIST restricts inheritance to exactly those, so the read
+// ends can be created inheritable without SetHandleInformation, and no other handle of
+// ours leaks into the child.
+BOOL LaunchChildProcess(ProcessLauncher* launcher, wchar_t* cmdLine, const wchar_t* workingDir, wchar_t* envBlock,
+                        HANDLE* outRead, HANDLE* errRead, PROCESS_INFORMATION* pi) {
+    SECURITY_ATTRIBUTES sa = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+    HANDLE hOutRd = NULL, hOutWr = NULL, hErrRd = NULL, hErrWr = NULL;
+    BOOL success = FALSE;
+    DWORD lastError = 0;
+
+    if (!CreatePipe(&hOutRd, &hOutWr, &sa, CHILD_PIPE_SIZE)) return FALSE;
+    if (!CreatePipe(&hErrRd, &hErrWr, &sa, CHILD_PIPE_SIZE)) {
+        lastError = GetLastError();
+        CloseHandle(hOutRd); CloseHandle(hOutWr);
+        SetLastError(lastError);
+        return FALSE;
+    }
+
+    HANDLE inherited[3];
+    int inheritedCount = 0;
+    inherited[inheritedCount++] = hOutWr;
+    inherited[inheritedCount++] = hErrWr;
+    if (launcher->nul_input) inherited[inheritedCount++] = launcher->nul_input;
+
+    SIZE_T attrSize = launcher->attr_list_size;
+    if (!InitializeProcThreadAttributeList(launcher->attr_list, 1, 0, &attrSize)) {
+        lastError = GetLastError();
+        goto close_pipes;
+    }
+    if (UpdateProcThreadAttribute(launcher->attr_list, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST,
+                                  inherited, inheritedCount * sizeof(HANDLE), NULL, NULL)) {
+        STARTUPINFOEXW siex = {0};
+        siex.StartupInfo.cb = sizeof(STARTUPINFOEXW);
+        siex.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+        siex.StartupInfo.hStdInput = launcher->nul_input;
+        siex.StartupInfo.hStdOutput = hOutWr;
+        siex.StartupInfo.hStdError = hErrWr;
+        siex.lpAttributeList = launcher->attr_list;
+
+        DWORD flags = CREATE_NO_WINDOW | EXTENDED_STARTUPINFO_PRESENT;
+        if (envBlock) flags |= CREATE_UNICODE_ENVIRONMENT;
+
+        success = CreateProcessW(NULL, cmdLine, NULL, NULL, TRUE, flags,
+                                 envBlock, workingDir, &siex.StartupInfo, pi);
+    }
+    lastError = GetLastError();
+    DeleteProcThreadAttributeList(launcher->attr_list);
+
+close_pipes:
+    // Parent must close its write ends so ReadFile on the read ends breaks when the child exits.
+    CloseHandle(hOutWr);
+    CloseHandle(hErrWr);
+    if (success) {
+        *outRead = hOutRd;
+        *errRead = hErrRd;
+    } else {
+        CloseHandle(hOutRd);
+        CloseHandle(hErrRd);
+        SetLastError(lastError);
+    }
+    return success;
+}
@@ -0,0 +1,98 @@
+#include "layout.h"
+
+int LayoutScale(int px96, int dpi) {
+    // Round to nearest, like MulDiv, so 1px gaps do not vanish at 125%.
+    return (px96 * dpi + LAYOUT_BASE_DPI / 2) / LAYOUT_BASE_DPI;
+}
+
+static void LayoutNodeInto(const LayoutNode* node, LayoutRect bounds, int dpi, LayoutRect* out, int outCount) {
+    if (node->kind == LAYOUT_LEAF) {
+        if (node->slot >= 0 && node->slot < outCount) out[node->slot] = bounds;
+        return;
+    }
+
+    int padding = LayoutScale(node->padding, dpi);
+    int gap = LayoutScale(node->gap, dpi);
+    LayoutRect inner = { bounds.x + padding, bounds.y + padding, bounds.w - 2 * padding, bounds.h - 2 * padding };
+    if (inner.w < 0) inner.w = 0;
+    if (inner.h < 0) inner.h = 0;
+
+    int horizontal = (node->kind == LAYOUT_ROW);
+    int available = horizontal ? inner.w : inner.h;
+
+    // First pass: what the fixed children and gaps take, and how much flex there is.
+    int used = 0;
+    int totalFlex = 0;
+    for (int i = 0; i < node->child_count; ++i) {
+        const LayoutNode* child = &node->children[i];
+        if (child->flex > 0) totalFlex += child->flex;
+        else used += LayoutScale(child->fixed, dpi);
+        if (i > 0) used += gap;
+    }
+    int leftover = available - used;
+    if (leftover < 0) leftover = 0;
+
+    // Second pass: place children; the last flex child takes the rounding remainder.
+    int pos = horizontal ? inner.x : inner.y;
+    int flexSeen = 0;
+    int flexGiven = 0;
+    for (int i = 0; i < node->child_count; ++i) {
+        const LayoutNode* child = &node->children[i];
+        int size;
+        if (child->flex > 0) {
+            flexSeen += child->flex;
+            size = (flexSeen == totalFlex) ? leftover - flexGiven
+                                           : (int)((long long)leftover * child->flex / totalFlex);
+            flexGiven += size;
+            int minSize = LayoutScale(child->min_size, dpi);
+            if (size < minSize) size = minSize;
+        } else {
+            size = LayoutScale(child->fixed, dpi);
+        }
+
+        LayoutRect childBounds = horizontal ? (LayoutRect){ pos, inner.y, size, inner.h }
+                                            : (LayoutRect){ inner.x, pos, inner.w, size };
+        LayoutNodeInto(child, childBounds, dpi, out, outCount);
+        pos += size + gap;
+    }
+}
+
+// Scales each size on its own, as LayoutNodeInto does, so the sum matches what it places.
+static void LayoutNodeMinSize(const LayoutNode* node, int dpi, int* width, int* height) {
+    *width = 0;
+    *height = 0;
+    if (node->kind == LAYOUT_LEAF) return;
+
+    int horizontal = (node->kind == LAYOUT_ROW);
+    int gap = LayoutScale(node->gap, dpi);
+    int along = 0;
+    int across = 0;
+    for (int i = 0; i < node->child_count; ++i) {
+        const LayoutNode* child = &node->children[i];
+        int childW, childH;
+        LayoutNodeMinSize(child, dpi, &childW, &childH);
+        int childAlong = horizontal ? childW : childH;
+        int childAcross = horizontal ? childH : childW;
+        int own = LayoutScale(child->flex > 0 ? child->min_size : child->fixed, dpi);
+        along += (own > childAlong ? own : childAlong) + (i > 0 ? gap : 0);
+        if (childAcross > across) across = childAcross;
+    }
+
+    int padding = LayoutScale(node->padding, dpi);
+    *width = (horizontal ? along : across) + 2 * padding;
+    *height = (horizontal ? across : along) + 2 * padding;
+}
+
+void LayoutMinSize(const LayoutNode* root, int dpi, int* width, int* height) {
+    *width = 0;
+    *height = 0;
+    if (!root) return;
+    if (dpi <= 0) dpi = LAYOUT_BASE_DPI;
+    LayoutNodeMinSize(root, dpi, width, height);
+}
+
+void LayoutCompute(const LayoutNode* root, LayoutRect bounds, int dpi, LayoutRect* out, int outCount) {
+    if (!root || !out) return;
+    if (dpi <= 0) dpi = LAYOUT_BASE_DPI;
+    LayoutNodeInto(root, bounds, dpi, out, outCount);
+}
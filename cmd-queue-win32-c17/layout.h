@@ -0,0 +1,42 @@
+// Declarative row/column layout. Plain C with no Win32 dependency, so the geometry
+// math can be compiled and checked on any platform.
+#ifndef CMDQ_LAYOUT_H
+#define CMDQ_LAYOUT_H
+
+#define LAYOUT_BASE_DPI 96
+#define LAYOUT_NO_SLOT  (-1) // Leaf that only takes up space
+
+typedef enum {
+    LAYOUT_LEAF,   // A single control, identified by its slot
+    LAYOUT_ROW,    // Children laid out left to right
+    LAYOUT_COLUMN  // Children laid out top to bottom
+} LayoutKind;
+
+// Sizes are in 96-DPI pixels and scaled at compute time.
+typedef struct LayoutNode {
+    LayoutKind kind;
+    int fixed;     // Size along the parent's axis when flex == 0
+    int flex;      // Share of the parent's leftover space, 0 for fixed-size nodes
+    int min_size;  // Lower bound for flex nodes when space runs out
+    int padding;   // Containers: inset on all four sides
+    int gap;       // Containers: space between consecutive children
+    int slot;      // Leaves: index into the output rect array, or LAYOUT_NO_SLOT
+    const struct LayoutNode* children;
+    int child_count;
+} LayoutNode;
+
+typedef struct {
+    int x, y, w, h;
+} LayoutRect;
+
+int LayoutScale(int px96, int dpi);
+
+// Computes the rect of every leaf under root within bounds. Each leaf with a slot in
+// [0, outCount) is written to out[slot]; children fill their container's cross axis.
+void LayoutCompute(const LayoutNode* root, LayoutRect bounds, int dpi, LayoutRect* out, int outCount);
+
+// Smallest bounds in which LayoutCompute gives every flex node at least its min_size and
+// nothing overflows. Leaves have no extent of their own on their parent's cross axis.
+void LayoutMinSize(const LayoutNode* root, int dpi, int* width, int* height);
+
+#endif // CMDQ_LAYOUT_H
@@ -0,0 +1,191 @@
+// Host-built checks for layout.c and the main window tree (make test).
+#include <stdio.h>
+
+#include "layout.h"
+#include "window_layout.h"
+
+static int g_checks = 0;
+static int g_failures = 0;
+
+#define CHECK_EQ(actual, expected) do { \
+    int a_ = (actual), e_ = (expected); \
+    g_checks++; \
+    if (a_ != e_) { \
+        g_failures++; \
+        fprintf(stderr, "%s:%d: %s is %d, expected %d\n", __FILE__, __LINE__, #actual, a_, e_); \
+    } \
+} while (0)
+
+#define CHECK_RECT(r, ex, ey, ew, eh) do { \
+    CHECK_EQ((r).x, ex); CHECK_EQ((r).y, ey); CHECK_EQ((r).w, ew); CHECK_EQ((r).h, eh); \
+} while (0)
+
+static void TestFixedAndFlex(void) {
+    const LayoutNode items[] = {
+        { .kind = LAYOUT_LEAF, .fixed = 50, .slot = 0 },
+        { .kind = LAYOUT_LEAF, .flex = 1, .slot = 1 },
+        { .kind = LAYOUT_LEAF, .flex = 2, .slot = 2 },
+        { .kind = LAYOUT_LEAF, .fixed = 40, .slot = 3 },
+    };
+    const LayoutNode row = { .kind = LAYOUT_ROW, .gap = 0, .slot = LAYOUT_NO_SLOT, .children = items, .child_count = 4 };
+    LayoutRect out[4];
+    LayoutCompute(&row, (LayoutRect){ 0, 0, 300, 20 }, 96, out, 4);
+    CHECK_RECT(out[0], 0, 0, 50, 20);
+    CHECK_RECT(out[1], 50, 0, 70, 20);  // 210 left over, split 1:2
+    CHECK_RECT(out[2], 120, 0, 140, 20);
+    CHECK_RECT(out[3], 260, 0, 40, 20);
+}
+
+static void TestRoundingRemainder(void) {
+    const LayoutNode items[] = {
+        { .kind = LAYOUT_LEAF, .flex = 1, .slot = 0 },
+        { .kind = LAYOUT_LEAF, .flex = 1, .slot = 1 },
+        { .kind = LAYOUT_LEAF, .flex = 1, .slot = 2 },
+    };
+    const LayoutNode column = { .kind = LAYOUT_COLUMN, .slot = LAYOUT_NO_SLOT, .children = items, .child_count = 3 };
+    LayoutRect out[3];
+    LayoutCompute(&column, (LayoutRect){ 5, 7, 30, 100 }, 96, out, 3);
+    CHECK_RECT(out[0], 5, 7, 30, 33);
+    CHECK_RECT(out[1], 5, 40, 30, 33);
+    CHECK_RECT(out[2], 5, 73, 30, 34); // Last flex child takes the remainder
+    CHECK_EQ(out[0].h + out[1].h + out[2].h, 100);
+}
+
+static void TestMinSize(void) {
+    const LayoutNode items[] = {
+        { .kind = LAYOUT_LEAF, .fixed = 90, .slot = 0 },
+        { .kind = LAYOUT_LEAF, .flex = 1, .min_size = 30, .slot = 1 },
+    };
+    const LayoutNode row = { .kind = LAYOUT_ROW, .gap = 5, .slot = LAYOUT_NO_SLOT, .children = items, .child_count = 2 };
+    LayoutRect out[2];
+    LayoutCompute(&row, (LayoutRect){ 0, 0, 100, 10 }, 96, out, 2);
+    CHECK_RECT(out[1], 95, 0, 30, 10); // Overflows rather than shrinking below min_size
+
+    LayoutCompute(&row, (LayoutRect){ 0, 0, 200, 10 }, 96, out, 2);
+    CHECK_RECT(out[1], 95, 0, 105, 10);
+
+    // At 144 DPI min_size scales too: 30 -> 45.
+    LayoutCompute(&row, (LayoutRect){ 0, 0, 100, 10 }, 144, out, 2);
+    CHECK_EQ(out[1].w, 45);
+}
+
+static void TestDpiScaling(void) {
+    CHECK_EQ(LayoutScale(10, 96), 10);
+    CHECK_EQ(LayoutScale(10, 120), 13); // 12.5 rounds up
+    CHECK_EQ(LayoutScale(5, 120), 6);   // 6.25 rounds down
+    CHECK_EQ(LayoutScale(5, 144), 8);   // 7.5 rounds up
+    CHECK_EQ(LayoutScale(1, 120), 1);   // 1px gaps survive 125%
+
+    const LayoutNode items[] = {
+        { .kind = LAYOUT_LEAF, .fixed = 20, .slot = 0 },
+        { .kind = LAYOUT_LEAF, .fixed = 20, .slot = 1 },
+    };
+    const LayoutNode column = { .kind = LAYOUT_COLUMN, .padding = 10, .gap = 5, .slot = LAYOUT_NO_SLOT,
+                                .children = items, .child_count = 2 };
+    const int dpis[] = { 96, 120, 144 };
+    const int padding[] = { 10, 13, 15 };
+    const int gap[] = { 5, 6, 8 };
+    const int size[] = { 20, 25, 30 };
+    for (int i = 0; i < 3; ++i) {
+        LayoutRect out[2];
+        LayoutCompute(&column, (LayoutRect){ 0, 0, 400, 300 }, dpis[i], out, 2);
+        CHECK_RECT(out[0], padding[i], padding[i], 400 - 2 * padding[i], size[i]);
+        CHECK_EQ(out[1].y, padding[i] + size[i] + gap[i]);
+        CHECK_EQ(out[1].h, size[i]);
+    }
+}
+
+// The rects the original CreateControls placed by hand, for a given client size.
+static void HandPlacedRects(int clientW, int clientH, LayoutRect* out) {
+    int margin = 10, gap = 5, controlHeight = 25, labelHeight = 20;
+    int editWidth = clientW - 2 * margin;
+    int y = 10;
+    out[SLOT_PREFIX_LABEL] = (LayoutRect){ margin, y, editWidth, labelHeight };     y += labelHeight + gap;
+    out[SLOT_PREFIX_EDIT] = (LayoutRect){ margin, y, editWidth, controlHeight };    y += controlHeight + gap * 2;
+    out[SLOT_DASHBOARD_LABEL] = (LayoutRect){ margin, y, editWidth, labelHeight };  y += labelHeight + gap;
+    out[SLOT_DASHBOARD] = (LayoutRect){ margin, y, editWidth, 80 };                 y += 80 + gap * 2;
+    out[SLOT_LOG_LABEL] = (LayoutRect){ margin, y, editWidth, labelHeight };        y += labelHeight + gap;
+    int logHeight = clientH - y - controlHeight - gap * 3 - margin;
+    if (logHeight < 50) logHeight = 50;
+    out[SLOT_LOG] = (LayoutRect){ margin, y, editWidth, logHeight };                y += logHeight + gap * 2;
+    out[SLOT_INPUT_EDIT] = (LayoutRect){ 0, y, 0, controlHeight }; // Only the row's y and height compare
+}
+
+static void TestMatchesHandPlacedLayout(void) {
+    // Client area of the default 600x500 window with standard borders, plus a few other sizes.
+    const int sizes[][2] = { { 584, 461 }, { 644, 400 }, { 900, 700 } };
+    for (int i = 0; i < 3; ++i) {
+        LayoutRect expected[SLOT_COUNT], actual[SLOT_COUNT];
+        HandPlacedRects(sizes[i][0], sizes[i][1], expected);
+        LayoutCompute(&g_mainLayout, (LayoutRect){ 0, 0, sizes[i][0], sizes[i][1] }, 96, actual, SLOT_COUNT);
+        for (int slot = SLOT_PREFIX_LABEL; slot <= SLOT_LOG; ++slot) {
+            CHECK_RECT(actual[slot], expected[slot].x, expected[slot].y, expected[slot].w, expected[slot].h);
+        }
+        // The input row has gained controls since, but sits where it used to.
+        for (int slot = SLOT_GROUP_COMBO; slot <= SLOT_BUTTON_EXPORT; ++slot) {
+            CHECK_EQ(actual[slot].y, expected[SLOT_INPUT_EDIT].y);
+            CHECK_EQ(actual[slot].h, expected[SLOT_INPUT_EDIT].h);
+        }
+        CHECK_EQ(actual[SLOT_GROUP_COMBO].x, 10);
+        CHECK_EQ(actual[SLOT_BUTTON_EXPORT].x + actual[SLOT_BUTTON_EXPORT].w, sizes[i][0] - 10);
+    }
+}
+
+static void TestLayoutMinSize(void) {
+    const LayoutNode inner[] = {
+        { .kind = LAYOUT_LEAF, .fixed = 40, .slot = 0 },
+        { .kind = LAYOUT_LEAF, .flex = 1, .min_size = 30, .slot = 1 },
+    };
+    const LayoutNode items[] = {
+        { .kind = LAYOUT_LEAF, .fixed = 20, .slot = 2 },
+        { .kind = LAYOUT_ROW, .fixed = 25, .gap = 5, .slot = LAYOUT_NO_SLOT, .children = inner, .child_count = 2 },
+        { .kind = LAYOUT_LEAF, .flex = 1, .min_size = 50, .slot = 3 },
+    };
+    const LayoutNode column = { .kind = LAYOUT_COLUMN, .padding = 10, .gap = 5, .slot = LAYOUT_NO_SLOT, .children = items, .child_count = 3 };
+    int width, height;
+    LayoutMinSize(&column, 96, &width, &height);
+    CHECK_EQ(width, 10 + 40 + 5 + 30 + 10); // The row is the widest child
+    CHECK_EQ(height, 10 + 20 + 5 + 25 + 5 + 50 + 10);
+    LayoutMinSize(&column, 144, &width, &height);
+    CHECK_EQ(width, 15 + 60 + 8 + 45 + 15);
+    CHECK_EQ(height, 15 + 30 + 8 + 38 + 8 + 75 + 15);
+
+    // The main window: the input row sets the width, the log's min_size the height.
+    LayoutMinSize(&g_mainLayout, 96, &width, &height);
+    CHECK_EQ(width, 10 + 90 + 5 + 110 + 5 + 80 + 5 + 60 + 5 + 100 + 5 + 70 + 10);
+    CHECK_EQ(width <= 600 - 16, 1); // Fits the default window with standard borders
+}
+
+static void TestMainLayoutAtHighDpi(void) {
+    const int dpis[] = { 96, 120, 144 };
+    for (int i = 0; i < 3; ++i) {
+        // The client area at the minimum window size
+        int width, height;
+        LayoutMinSize(&g_mainLayout, dpis[i], &width, &height);
+        LayoutRect out[SLOT_COUNT];
+        LayoutCompute(&g_mainLayout, (LayoutRect){ 0, 0, width, height }, dpis[i], out, SLOT_COUNT);
+        for (int slot = SLOT_PREFIX_EDIT; slot <= SLOT_LOG; ++slot) {
+            CHECK_EQ(out[slot].y >= out[slot - 1].y + out[slot - 1].h, 1); // Stacked without overlap
+        }
+        for (int slot = SLOT_PROFILE_COMBO; slot <= SLOT_BUTTON_EXPORT; ++slot) {
+            CHECK_EQ(out[slot].x, out[slot - 1].x + out[slot - 1].w + LayoutScale(5, dpis[i]));
+        }
+        CHECK_EQ(out[SLOT_INPUT_EDIT].w, LayoutScale(60, dpis[i]));
+        CHECK_EQ(out[SLOT_LOG].h, LayoutScale(50, dpis[i]));
+        CHECK_EQ(out[SLOT_BUTTON_EXPORT].x + out[SLOT_BUTTON_EXPORT].w, width - LayoutScale(10, dpis[i]));
+        // The trailing spacer keeps a gap plus the padding below the input row.
+        CHECK_EQ(out[SLOT_BUTTON_EXPORT].y + out[SLOT_BUTTON_EXPORT].h, height - LayoutScale(10, dpis[i]) - LayoutScale(5, dpis[i]));
+    }
+}
+
+int main(void) {
+    TestFixedAndFlex();
+    TestRoundingRemainder();
+    TestMinSize();
+    TestDpiScaling();
+    TestMatchesHandPlacedLayout();
+    TestLayoutMinSize();
+    TestMainLayoutAtHighDpi();
+    printf("layout_test: %d checks, %d failed\n", g_checks, g_failures);
+    return g_failures ? 1 : 0;
+}
@@ -2,16 +2,37 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 #include <wchar.h> // For wcscat_s, wcscpy_s, etc. _wcsdup
 #include <tchar.h> // For _TCHAR, _tcscpy, etc. (though direct W functions are used)
 #include <commctrl.h> // For some common controls if ever needed, not strictly for this set.
+#include <shellapi.h> // CommandLineToArgvW
+
+#include "layout.h"
+#include "window_layout.h"
+#include "timerwheel.h"
+#include "export.h"
+#include "launcher.h"
+#include "scheduler.h"
+#include "tasklog.h"
 
 // --- Configuration ---
 #define MAX_LOG_LINES_IN_EDIT_CONTROL 200
 #define DEFAULT_CMD_PREFIX L"yt-dlp --js-runtimes quickjs --cookies cookies.txt -f 140 -N 12"
+#define DEFAULT_VIDEO_PREFIX L"yt-dlp --js-runtimes quickjs --cookies cookies.txt -N 12"
+#define TASK_SUFFIX_PLACEHOLDER L"{}" // In a group prefix, replaced by the suffix instead of appending it
 #define WINDOW_CLASS_NAME L"CmdQueueGUIWindowClass"
-#define MAX_QUEUE_SIZE 100
-#define PIPE_BUFFER_SIZE 4096
+#define WORKER_THREAD_COUNT 4 // Upper bound on tasks running at once across all groups
+#define MAX_DASHBOARD_ITEMS 50
+#define TIMER_TICK_MS 100     // Resolution of scheduled starts and start-rate limits
+#define HISTORY_CHUNK_RECORDS 4096 // Finished tasks per history chunk; chunks never move once allocated
+#define EXPORT_BUFFER_SIZE (1 << 20)
+#define MAX_LAUNCH_PROFILES 8
+#define DEFAULT_PROFILE_NAME L"Default"
+
+// Log flow to the UI thread (the per-task budget is in tasklog.h)
+#define MAX_PENDING_LOG_CHUNKS 512          // Chunks posted but not yet drawn before pipe readers wait
+#define MAX_EARLY_LOG_CHUNKS   64           // Messages kept from before the main window exists
 
 // --- Control IDs ---
 #define IDC_STATIC_PREFIX_LABEL    100
@@ -23,23 +44,64 @@
 #define IDC_STATIC_INPUT_LABEL     106
 #define IDC_EDIT_INPUT             107 // Suffix input
 #define IDC_BUTTON_ADD             108
+#define IDC_COMBO_PROFILE          109
+#define IDC_COMBO_GROUP            110
+#define IDC_BUTTON_EXPORT          111
 
 // --- Custom Window Messages ---
 #define WM_APP_APPEND_LOG_CHUNK (WM_APP + 1) // lParam is LogChunk*, wParam is 0 for stdout, 1 for stderr
 #define WM_APP_UPDATE_DASHBOARD (WM_APP + 2)
-#define WM_APP_COMMAND_DONE     (WM_APP + 3) // Signals command processor finished a task
+#define WM_APP_COMMAND_DONE     (WM_APP + 3) // Signals command processor finished a task, wParam is the worker index
 
 // --- Structures ---
+// The task a worker is running, so exports can list it. Guarded by g_historyLock.
+typedef struct {
+    BOOL active;
+    QueuedTask task;           // prefix/suffix stay owned by the worker
+    ULONGLONG started_unix_ms;
+} RunningTask;
+
+typedef struct {
+    wchar_t name[64];
+    wchar_t* working_dir;      // NULL inherits the app's current directory
+    wchar_t* env_overrides;    // "NAME=VALUE\0...\0\0" from --env; "NAME=" removes NAME
+    size_t env_overrides_len;  // Characters used in env_overrides, excluding the final terminator
+    wchar_t* env_block;        // Merged block handed to CreateProcessW, NULL inherits ours
+} LaunchProfile;
+
+// Marks a task's lines in the log: each one is prefixed with the tag, and a progress line
+// only ever replaces a line the same task wrote as progress.
+typedef struct {
+    LONG task_id;     // From g_lastLogTaskId, never 0 (the app's own messages use 0)
+    wchar_t tag[48];  // "[group #id]"
+} TaskLogTag;
+
+// Shared by a task's stdout and stderr readers.
+typedef struct {
+    CRITICAL_SECTION lock;         // Guards budget
+    const TaskLogTag* tag;
+    TaskLogBudget budget;
+    volatile LONG cancelled;       // Set by the worker when it gives up on the readers
+} TaskLog;
+
 typedef struct {
-    wchar_t* prefix;
-    wchar_t* suffix;
-} QueuedTask;
+    HANDLE pipe;
+    BOOL is_stderr;
+    TaskLog* log;
+} PipeReaderContext;
 
 typedef struct {
-    wchar_t* text;      // Dynamically allocated wide string
-    BOOL is_progress_line; // True if this line should replace the previous one in display
+    wchar_t* text;      // Dynamically allocated wide string, one line without its line break
+    BOOL is_progress_line; // True if this line should replace the task's previous progress line
+    LONG task_id;       // TaskLogTag.task_id of the task that wrote it, 0 for the app's own messages
 } LogChunk;
 
+// Where a running task's latest progress line sits in g_hwndLog. UI thread only.
+typedef struct {
+    LONG task_id;       // 0 for a free slot
+    ULONGLONG line;     // Counted like g_logLinesAppended
+} LogProgressLine;
+
 // --- Global Variables ---
 // Handles
 HINSTANCE g_hInstance = NULL;
@@ -49,47 +111,123 @@ HWND g_hwndDashboardLabel, g_hwndDashboard;
 HWND g_hwndLogLabel, g_hwndLog;
 HWND g_hwndInputLabel, g_hwndInputEdit; // Suffix input
 HWND g_hwndButtonAdd;
+HWND g_hwndProfileCombo;
+HWND g_hwndGroupCombo;
+HWND g_hwndButtonExport;
+int g_selectedGroup = 0; // Group whose prefix is in g_hwndPrefixEdit, UI thread only
 HFONT g_hFont = NULL;
+int g_dpi = LAYOUT_BASE_DPI; // From GetDeviceCaps(LOGPIXELSY), read once at startup
 
-// Command Queue
-QueuedTask g_taskQueue[MAX_QUEUE_SIZE];
-int g_queueHead = 0;
-int g_queueTail = 0;
-int g_queueCount = 0;
+// Log pane bookkeeping, UI thread only. Line numbers count every line ever appended, so
+// they stay valid while old lines are trimmed from the top.
+ULONGLONG g_logLinesAppended = 0;
+ULONGLONG g_logLinesTrimmed = 0;
+LogProgressLine g_logProgressLines[WORKER_THREAD_COUNT];
+
+// Geometry of the last applied layout; WM_SIZE skips the work when nothing changed
+HWND g_layoutHwnds[SLOT_COUNT];
+LayoutRect g_layoutRects[SLOT_COUNT];
+int g_layoutWidth = -1, g_layoutHeight = -1;
+
+// Command Queue (one FIFO per task group, served by a pool of workers)
+Scheduler g_scheduler;        // Guarded by g_queueLock, except group prefixes which only the UI thread touches
 CRITICAL_SECTION g_queueLock;
 CONDITION_VARIABLE g_queueNotEmpty;
-HANDLE g_hCommandProcessorThread = NULL;
+HANDLE g_hWorkerThreads[WORKER_THREAD_COUNT];
+int g_workerThreadCount = 0;
 BOOL g_appExiting = FALSE;
+volatile LONG g_lastLogTaskId = 0;  // Source of TaskLogTag.task_id
+volatile LONG g_pendingLogChunks = 0; // Log chunks posted to the UI and not yet processed
+CRITICAL_SECTION g_logRoomLock;       // Pipe readers wait on g_logRoom while the UI is behind
+CONDITION_VARIABLE g_logRoom;         // Woken when g_pendingLogChunks drops below MAX_PENDING_LOG_CHUNKS
+struct { LogChunk* chunk; BOOL is_stderr; } g_earlyLogChunks[MAX_EARLY_LOG_CHUNKS]; // See PostLogChunk
+int g_earlyLogChunkCount = 0;
+
+// Run History (append-only chunks, so exports can read published records without a lock)
+TaskRecord** g_historyChunks = NULL;
+size_t g_historyChunkCapacity = 0;
+size_t g_historyCount = 0;
+CRITICAL_SECTION g_historyLock;
+RunningTask g_runningTasks[WORKER_THREAD_COUNT]; // Indexed by worker
+volatile LONG g_exportRunning = 0;
+HANDLE g_hExportThread = NULL; // Last export thread, joined at exit; UI thread only
 
 // Dashboard State
-wchar_t g_currentCommand[512] = L"Idle";
+wchar_t g_workerCommands[WORKER_THREAD_COUNT][512]; // What each worker runs, empty when idle
 CRITICAL_SECTION g_dashboardLock;
 
-// Initial command prefix (can be set by command line argument in a more complex setup)
-const wchar_t* g_initialCmdPrefix = DEFAULT_CMD_PREFIX;
+// Launch profiles (working directory + environment), configured from the command line
+LaunchProfile g_profiles[MAX_LAUNCH_PROFILES];
+int g_profileCount = 0;
+HANDLE g_hNulInput = NULL; // Inheritable NUL device handed to every child as stdin
 
 
 // --- Forward Declarations ---
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 DWORD WINAPI CommandProcessorThread(LPVOID lpParam);
-void AddToQueue(const wchar_t* prefix, const wchar_t* suffix);
+void AddToQueue(const wchar_t* prefix, const wchar_t* suffix, int profileIndex, int groupIndex, ULONGLONG notBeforeMs);
 void UpdateDashboardUI(void);
 void PostLogChunkToUI(const char* utf8_chunk, BOOL is_stderr_color_hint, BOOL is_progress);
 void PostLogChunkToUI_Wide(const wchar_t* wide_chunk, BOOL is_stderr_color_hint, BOOL is_progress);
+void PostTaskLogLine(const TaskLogTag* tag, const char* utf8_line, BOOL isStdErr, BOOL isProgress);
+void PostTaskLogLine_Wide(const TaskLogTag* tag, const wchar_t* line, BOOL isStdErr, BOOL isProgress);
+void FlushEarlyLogChunks(void);
+void AppendLogChunk(const LogChunk* chunk);
+void LogChunkDone(void);
+void WakeLogWriters(void);
 wchar_t* Utf8ToWide(const char* utf8String);
 // char* WideToUtf8(const wchar_t* wideString); // For command arguments if needed (not currently used)
 void InitializeUIFont(void);
 void CreateControls(HWND hwndParent);
+void LayoutControls(HWND hwndParent, BOOL force);
 void TrimTrailingCr(wchar_t* str);
+void InitTaskLog(TaskLog* log, const TaskLogTag* tag);
+void SubmitTaskLogLine(TaskLog* log, const char* line, BOOL isStdErr, BOOL isProgress);
+void FlushTaskLog(TaskLog* log);
+void FreeTaskLog(TaskLog* log);
+void FormatCount(wchar_t* buffer, size_t bufferLen, ULONGLONG value);
+void ParseCommandLineArgs(void);
+TaskGroup* AddTaskGroup(const wchar_t* name, const wchar_t* prefix, int maxRunning);
+TaskGroup* FindTaskGroup(const wchar_t* name);
+void FreeTaskGroups(void);
+void ExpandTaskCommand(const wchar_t* prefix, const wchar_t* suffix, wchar_t* out, size_t outLen);
+void SelectTaskGroup(int groupIndex);
+void CompleteTask(TaskRecord* record, int workerIndex);
+void FreeTaskHistory(void);
+DWORD WINAPI ExportThread(LPVOID lpParam);
+ULONGLONG UnixTimeMs(void);
+BOOL ParseScheduleDirective(wchar_t* suffix, ULONGLONG* delayMs);
+LaunchProfile* AddLaunchProfile(const wchar_t* name);
+BOOL AddProfileEnvOverride(LaunchProfile* profile, const wchar_t* assignment);
+wchar_t* BuildEnvironmentBlock(const wchar_t* overrides);
+void FreeLaunchProfiles(void);
 
 
 // --- Entry Point ---
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
     g_hInstance = hInstance;
-    
+    // Without this Windows reports 96 DPI and bitmap-stretches the window, so the layout
+    // and font scaling below never kick in.
+    SetProcessDPIAware();
+
     InitializeCriticalSection(&g_queueLock);
     InitializeCriticalSection(&g_dashboardLock);
+    InitializeCriticalSection(&g_historyLock);
     InitializeConditionVariable(&g_queueNotEmpty);
+    InitializeCriticalSection(&g_logRoomLock);
+    InitializeConditionVariable(&g_logRoom);
+    SchedulerInit(&g_scheduler, TIMER_TICK_MS, GetTickCount64());
+
+    ParseCommandLineArgs();
+    for (int i = 0; i < g_profileCount; ++i) {
+        if (g_profiles[i].env_overrides) {
+            g_profiles[i].env_block = BuildEnvironmentBlock(g_profiles[i].env_overrides);
+        }
+    }
+
+    SECURITY_ATTRIBUTES nulSa = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+    g_hNulInput = CreateFileW(L"NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, &nulSa, OPEN_EXISTING, 0, NULL);
+    if (g_hNulInput == INVALID_HANDLE_VALUE) g_hNulInput = NULL; // Children then get no stdin at all
 
     WNDCLASSEXW wcex = {0};
     wcex.cbSize = sizeof(WNDCLASSEXW);
@@ -112,17 +250,30 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 
     InitializeUIFont();
     PostLogChunkToUI("Application starting...", FALSE, FALSE);
-    wchar_t initialMsg[256];
-    swprintf(initialMsg, 256, L"Initial command prefix set to: %s (editable in GUI)", g_initialCmdPrefix);
-    PostLogChunkToUI_Wide(initialMsg, FALSE, TRUE); 
+    for (int i = 0; i < g_scheduler.group_count; ++i) {
+        wchar_t groupMsg[768];
+        swprintf(groupMsg, sizeof(groupMsg)/sizeof(wchar_t), L"Group '%s' (max %d running): %s",
+                 g_scheduler.groups[i].name, g_scheduler.groups[i].max_running, g_scheduler.groups[i].prefix);
+        PostLogChunkToUI_Wide(groupMsg, FALSE, FALSE);
+    }
+    PostLogChunkToUI("Pick a group, edit its prefix if needed ('{}' marks where the suffix goes).", FALSE, FALSE);
+    PostLogChunkToUI("Start a suffix with '+30m' (or s/h) or '@23:00' to run it later.", FALSE, FALSE);
     PostLogChunkToUI("Enter command suffix and click 'Add to Queue' or press Enter.", FALSE, FALSE);
     PostLogChunkToUI("Close window or press Alt+F4 to quit.", FALSE, FALSE);
+    for (int i = 0; i < g_profileCount; ++i) {
+        wchar_t profileMsg[MAX_PATH + 128];
+        swprintf(profileMsg, sizeof(profileMsg)/sizeof(wchar_t), L"Profile '%s': cwd=%s, env=%s",
+                 g_profiles[i].name,
+                 g_profiles[i].working_dir ? g_profiles[i].working_dir : L"(inherit)",
+                 g_profiles[i].env_block ? L"custom" : L"(inherit)");
+        PostLogChunkToUI_Wide(profileMsg, FALSE, FALSE);
+    }
 
 
     int screenWidth = GetSystemMetrics(SM_CXSCREEN);
     int screenHeight = GetSystemMetrics(SM_CYSCREEN);
-    int windowWidth = 600;
-    int windowHeight = 500; // Increased height a bit for more dashboard visibility
+    int windowWidth = LayoutScale(600, g_dpi);
+    int windowHeight = LayoutScale(500, g_dpi); // Increased height a bit for more dashboard visibility
     int windowX = (screenWidth - windowWidth) / 2;
     int windowY = (screenHeight - windowHeight) / 2;
 
@@ -140,11 +291,15 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         return 0;
     }
 
+    FlushEarlyLogChunks(); // Startup messages and command line warnings logged so far
     ShowWindow(g_hwndMain, nCmdShow);
     UpdateWindow(g_hwndMain);
 
-    g_hCommandProcessorThread = CreateThread(NULL, 0, CommandProcessorThread, NULL, 0, NULL);
-    if (g_hCommandProcessorThread == NULL) {
+    for (int i = 0; i < WORKER_THREAD_COUNT; ++i) {
+        HANDLE hWorker = CreateThread(NULL, 0, CommandProcessorThread, (LPVOID)(INT_PTR)i, 0, NULL);
+        if (hWorker) g_hWorkerThreads[g_workerThreadCount++] = hWorker;
+    }
+    if (g_workerThreadCount == 0) {
         MessageBoxW(NULL, L"Failed to create command processor thread!", L"Error", MB_ICONEXCLAMATION | MB_OK);
         return 1;
     }
@@ -162,19 +317,30 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         DispatchMessage(&msg);
     }
 
-    if (g_hCommandProcessorThread) {
+    if (g_workerThreadCount > 0) {
         g_appExiting = TRUE;
         EnterCriticalSection(&g_queueLock);
-        WakeConditionVariable(&g_queueNotEmpty); 
+        WakeAllConditionVariable(&g_queueNotEmpty); 
         LeaveCriticalSection(&g_queueLock);
-        WaitForSingleObject(g_hCommandProcessorThread, INFINITE);
-        CloseHandle(g_hCommandProcessorThread);
+        WaitForMultipleObjects(g_workerThreadCount, g_hWorkerThreads, TRUE, INFINITE);
+        for (int i = 0; i < g_workerThreadCount; ++i) CloseHandle(g_hWorkerThreads[i]);
+    }
+    if (g_hExportThread) { // Reads the queue and history freed below; stops early once g_appExiting is set
+        g_appExiting = TRUE;
+        WaitForSingleObject(g_hExportThread, INFINITE);
+        CloseHandle(g_hExportThread);
     }
 
     DeleteCriticalSection(&g_queueLock);
     DeleteCriticalSection(&g_dashboardLock);
+    DeleteCriticalSection(&g_logRoomLock);
     
     if (g_hFont) DeleteObject(g_hFont);
+    if (g_hNulInput) CloseHandle(g_hNulInput);
+    FreeLaunchProfiles();
+    FreeTaskGroups();
+    FreeTaskHistory();
+    DeleteCriticalSection(&g_historyLock);
     
     return (int)msg.wParam;
 }
@@ -192,7 +358,18 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             WORD controlId = LOWORD(wParam);
             WORD notifyCode = HIWORD(wParam); 
 
-            if (controlId == IDC_BUTTON_ADD && notifyCode == BN_CLICKED) {
+            if (controlId == IDC_COMBO_GROUP && notifyCode == CBN_SELCHANGE) {
+                int groupIndex = (int)SendMessageW(g_hwndGroupCombo, CB_GETCURSEL, 0, 0);
+                if (groupIndex >= 0 && groupIndex < g_scheduler.group_count) SelectTaskGroup(groupIndex);
+            } else if (controlId == IDC_BUTTON_EXPORT && notifyCode == BN_CLICKED) {
+                if (InterlockedExchange(&g_exportRunning, 1) == 0) {
+                    if (g_hExportThread) CloseHandle(g_hExportThread); // Previous export, done but for its return
+                    g_hExportThread = CreateThread(NULL, 0, ExportThread, NULL, 0, NULL);
+                    if (!g_hExportThread) InterlockedExchange(&g_exportRunning, 0);
+                } else {
+                    PostLogChunkToUI("An export is already running.", TRUE, FALSE);
+                }
+            } else if (controlId == IDC_BUTTON_ADD && notifyCode == BN_CLICKED) {
                 wchar_t prefix_buffer[512];
                 wchar_t suffix_buffer[1024];
 
@@ -211,14 +388,31 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 while (*s && iswspace(*s)) s++;
                 memmove(suffix_buffer, s, (wcslen(s)+1)*sizeof(wchar_t));
 
+                ULONGLONG delayMs = 0;
+                BOOL scheduled = ParseScheduleDirective(suffix_buffer, &delayMs);
+
                 if (wcslen(prefix_buffer) == 0) {
                     PostLogChunkToUI("Error: Command prefix cannot be empty.", TRUE, FALSE);
                     SetFocus(g_hwndPrefixEdit);
                 } else {
-                    AddToQueue(prefix_buffer, suffix_buffer);
-                    wchar_t logMsg[1600];
-                    swprintf(logMsg, sizeof(logMsg)/sizeof(wchar_t), L"Added to queue: [%s] %s", prefix_buffer, suffix_buffer);
-                    PostLogChunkToUI_Wide(logMsg, FALSE, TRUE); 
+                    int profileIndex = (int)SendMessageW(g_hwndProfileCombo, CB_GETCURSEL, 0, 0);
+                    if (profileIndex < 0 || profileIndex >= g_profileCount) profileIndex = 0;
+                    TaskGroup* group = &g_scheduler.groups[g_selectedGroup];
+                    if (wcscmp(group->prefix, prefix_buffer) != 0) {
+                        wchar_t* prefixCopy = _wcsdup(prefix_buffer);
+                        if (prefixCopy) { free(group->prefix); group->prefix = prefixCopy; }
+                    }
+                    AddToQueue(prefix_buffer, suffix_buffer, profileIndex, g_selectedGroup,
+                               scheduled ? GetTickCount64() + delayMs : 0);
+                    wchar_t logMsg[1800];
+                    int written = swprintf(logMsg, sizeof(logMsg)/sizeof(wchar_t), L"Added to %s: [%s] %s", group->name, prefix_buffer, suffix_buffer);
+                    if (written > 0 && profileIndex != 0) {
+                        written += swprintf(logMsg + written, sizeof(logMsg)/sizeof(wchar_t) - written, L" (profile: %s)", g_profiles[profileIndex].name);
+                    }
+                    if (written > 0 && scheduled) {
+                        swprintf(logMsg + written, sizeof(logMsg)/sizeof(wchar_t) - written, L" (starts in %.1f min)", (double)delayMs / 60000.0);
+                    }
+                    PostLogChunkToUI_Wide(logMsg, FALSE, FALSE);
                     SetWindowTextW(g_hwndInputEdit, L"");
                     SetFocus(g_hwndInputEdit);
                     PostMessage(hwnd, WM_APP_UPDATE_DASHBOARD, 0, 0);
@@ -229,39 +423,9 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         
         case WM_APP_APPEND_LOG_CHUNK: {
             LogChunk* chunk = (LogChunk*)lParam;
+            LogChunkDone();
             if (!chunk || !chunk->text) break;
-
-            int currentLen = GetWindowTextLengthW(g_hwndLog);
-            SendMessageW(g_hwndLog, EM_SETSEL, currentLen, currentLen); 
-
-            if (chunk->is_progress_line) {
-                LRESULT lineCount = SendMessageW(g_hwndLog, EM_GETLINECOUNT, 0, 0);
-                if (lineCount > 0) {
-                    LRESULT lastLineStartCharIndex = SendMessageW(g_hwndLog, EM_LINEINDEX, lineCount - 1, 0);
-                    if (lastLineStartCharIndex != (LRESULT)-1) {
-                         SendMessageW(g_hwndLog, EM_SETSEL, lastLineStartCharIndex, -1); 
-                    }
-                }
-            }
-            
-            SendMessageW(g_hwndLog, EM_REPLACESEL, TRUE, (LPARAM)chunk->text);
-
-            LRESULT lines = SendMessageW(g_hwndLog, EM_GETLINECOUNT, 0, 0);
-            while (lines > MAX_LOG_LINES_IN_EDIT_CONTROL) {
-                LRESULT firstLineEnd = SendMessageW(g_hwndLog, EM_LINEINDEX, 1, 0); 
-                if (firstLineEnd == -1) { 
-                    SendMessageW(g_hwndLog, EM_SETSEL, 0, GetWindowTextLengthW(g_hwndLog)/2); 
-                } else {
-                    SendMessageW(g_hwndLog, EM_SETSEL, 0, firstLineEnd); 
-                }
-                SendMessageW(g_hwndLog, EM_REPLACESEL, TRUE, (LPARAM)L""); 
-                lines = SendMessageW(g_hwndLog, EM_GETLINECOUNT, 0, 0);
-            }
-
-            currentLen = GetWindowTextLengthW(g_hwndLog);
-            SendMessageW(g_hwndLog, EM_SETSEL, currentLen, currentLen);
-            SendMessageW(g_hwndLog, EM_SCROLLCARET, 0, 0);
-            
+            AppendLogChunk(chunk);
             free(chunk->text);
             free(chunk);
             break;
@@ -272,10 +436,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             break;
 
         case WM_APP_COMMAND_DONE:
-            EnterCriticalSection(&g_dashboardLock);
-            wcscpy_s(g_currentCommand, sizeof(g_currentCommand)/sizeof(wchar_t), L"Idle");
-            LeaveCriticalSection(&g_dashboardLock);
-            UpdateDashboardUI();
+            UpdateDashboardUI(); // The worker already cleared its slot
             break;
             
         case WM_ACTIVATE:
@@ -285,15 +446,20 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             break;
 
         case WM_SIZE:
-            // TODO: Implement control resizing here for better responsiveness
-            // Example:
-            // RECT rcClient;
-            // GetClientRect(hwnd, &rcClient);
-            // int newWidth = rcClient.right - rcClient.left - 2 * margin;
-            // MoveWindow(g_hwndPrefixEdit, margin, y_pos_prefix_edit, newWidth, controlHeight, TRUE);
-            // ... and so on for other controls ...
-            // RedrawWindow(hwnd, NULL, NULL, RDW_ERASE | RDW_INVALIDATE | RDW_ALLCHILDREN);
+            if (wParam != SIZE_MINIMIZED) LayoutControls(hwnd, FALSE);
+            break;
+
+        case WM_GETMINMAXINFO: {
+            // Just enough client area for the layout tree's fixed sizes and minimums
+            MINMAXINFO* mmi = (MINMAXINFO*)lParam;
+            int minWidth, minHeight;
+            LayoutMinSize(&g_mainLayout, g_dpi, &minWidth, &minHeight);
+            RECT minRect = { 0, 0, minWidth, minHeight };
+            AdjustWindowRectEx(&minRect, (DWORD)GetWindowLongW(hwnd, GWL_STYLE), FALSE, (DWORD)GetWindowLongW(hwnd, GWL_EXSTYLE));
+            mmi->ptMinTrackSize.x = minRect.right - minRect.left;
+            mmi->ptMinTrackSize.y = minRect.bottom - minRect.top;
             break;
+        }
 
         case WM_CLOSE:
             DestroyWindow(hwnd);
@@ -302,8 +468,9 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         case WM_DESTROY:
             g_appExiting = TRUE; 
             EnterCriticalSection(&g_queueLock);
-            WakeConditionVariable(&g_queueNotEmpty); 
+            WakeAllConditionVariable(&g_queueNotEmpty); 
             LeaveCriticalSection(&g_queueLock);
+            WakeLogWriters(); // Nothing drains the log any more
             PostQuitMessage(0);
             break;
 
@@ -314,311 +481,507 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 }
 
 // --- UI Helpers ---
+// Adds a chunk to the log pane as its own line. A progress line replaces the line its task
+// last wrote as progress, wherever that is now; any other line from the task ends that, so
+// the next progress update starts a new line below it.
+void AppendLogChunk(const LogChunk* chunk) {
+    LogProgressLine* progress = NULL;
+    if (chunk->task_id != 0) {
+        for (int i = 0; i < WORKER_THREAD_COUNT; ++i) {
+            if (g_logProgressLines[i].task_id == chunk->task_id) progress = &g_logProgressLines[i];
+        }
+    }
+
+    if (progress && chunk->is_progress_line) {
+        LRESULT start = SendMessageW(g_hwndLog, EM_LINEINDEX, (WPARAM)(progress->line - g_logLinesTrimmed), 0);
+        if (start != -1) {
+            LRESULT length = SendMessageW(g_hwndLog, EM_LINELENGTH, (WPARAM)start, 0);
+            SendMessageW(g_hwndLog, EM_SETSEL, (WPARAM)start, (LPARAM)(start + length));
+            SendMessageW(g_hwndLog, EM_REPLACESEL, FALSE, (LPARAM)chunk->text);
+            return;
+        }
+    }
+    if (progress) progress->task_id = 0;
+
+    int currentLen = GetWindowTextLengthW(g_hwndLog);
+    SendMessageW(g_hwndLog, EM_SETSEL, currentLen, currentLen);
+    if (currentLen > 0) SendMessageW(g_hwndLog, EM_REPLACESEL, FALSE, (LPARAM)L"\r\n");
+    SendMessageW(g_hwndLog, EM_REPLACESEL, FALSE, (LPARAM)chunk->text);
+    ULONGLONG line = g_logLinesAppended++;
+
+    if (chunk->is_progress_line && chunk->task_id != 0) {
+        // At most WORKER_THREAD_COUNT tasks run at once; take a free slot, else the oldest.
+        LogProgressLine* slot = &g_logProgressLines[0];
+        for (int i = 0; i < WORKER_THREAD_COUNT; ++i) {
+            if (g_logProgressLines[i].task_id == 0) { slot = &g_logProgressLines[i]; break; }
+            if (g_logProgressLines[i].line < slot->line) slot = &g_logProgressLines[i];
+        }
+        slot->task_id = chunk->task_id;
+        slot->line = line;
+    }
+
+    LRESULT lines = SendMessageW(g_hwndLog, EM_GETLINECOUNT, 0, 0);
+    while (lines > MAX_LOG_LINES_IN_EDIT_CONTROL) {
+        LRESULT firstLineEnd = SendMessageW(g_hwndLog, EM_LINEINDEX, 1, 0);
+        if (firstLineEnd == -1) break;
+        SendMessageW(g_hwndLog, EM_SETSEL, 0, firstLineEnd);
+        SendMessageW(g_hwndLog, EM_REPLACESEL, FALSE, (LPARAM)L"");
+        g_logLinesTrimmed++;
+        lines--;
+    }
+    for (int i = 0; i < WORKER_THREAD_COUNT; ++i) {
+        if (g_logProgressLines[i].task_id != 0 && g_logProgressLines[i].line < g_logLinesTrimmed) {
+            g_logProgressLines[i].task_id = 0; // Scrolled out of the pane
+        }
+    }
+
+    currentLen = GetWindowTextLengthW(g_hwndLog);
+    SendMessageW(g_hwndLog, EM_SETSEL, currentLen, currentLen);
+    SendMessageW(g_hwndLog, EM_SCROLLCARET, 0, 0);
+}
+
 void InitializeUIFont(void) {
+    HDC hdcScreen = GetDC(NULL);
+    if (hdcScreen) {
+        g_dpi = GetDeviceCaps(hdcScreen, LOGPIXELSY);
+        ReleaseDC(NULL, hdcScreen);
+    }
+    if (g_dpi <= 0) g_dpi = LAYOUT_BASE_DPI;
+
     LOGFONTW lf = {0};
-    lf.lfHeight = -MulDiv(10, GetDeviceCaps(GetDC(NULL), LOGPIXELSY), 72); 
+    lf.lfHeight = -MulDiv(10, g_dpi, 72); 
     lf.lfWeight = FW_NORMAL;
     lf.lfCharSet = DEFAULT_CHARSET;
     wcscpy_s(lf.lfFaceName, LF_FACESIZE, L"Segoe UI");
     g_hFont = CreateFontIndirectW(&lf);
 }
 
+// --- Layout ---
+// Computes geometry once for the current client size and moves every control in one
+// DeferWindowPos batch, so the window repaints once instead of once per control.
+void LayoutControls(HWND hwndParent, BOOL force) {
+    RECT rcClient;
+    GetClientRect(hwndParent, &rcClient);
+    int width = rcClient.right - rcClient.left;
+    int height = rcClient.bottom - rcClient.top;
+    if (!force && width == g_layoutWidth && height == g_layoutHeight) return;
+    g_layoutWidth = width;
+    g_layoutHeight = height;
+
+    LayoutRect bounds = { 0, 0, width, height };
+    LayoutCompute(&g_mainLayout, bounds, g_dpi, g_layoutRects, SLOT_COUNT);
+    // A combo box's height includes its drop-down list.
+    g_layoutRects[SLOT_GROUP_COMBO].h *= 8;
+    g_layoutRects[SLOT_PROFILE_COMBO].h *= 8;
+
+    HDWP hdwp = BeginDeferWindowPos(SLOT_COUNT);
+    for (int i = 0; i < SLOT_COUNT && hdwp; ++i) {
+        if (!g_layoutHwnds[i]) continue;
+        const LayoutRect* r = &g_layoutRects[i];
+        hdwp = DeferWindowPos(hdwp, g_layoutHwnds[i], NULL, r->x, r->y, r->w, r->h, SWP_NOZORDER | SWP_NOACTIVATE);
+    }
+    if (hdwp) EndDeferWindowPos(hdwp);
+}
+
+// Creates the controls at zero size; LayoutControls places them.
+static HWND CreateChildControl(HWND hwndParent, int slot, DWORD exStyle, const wchar_t* className,
+                               const wchar_t* text, DWORD style, int controlId) {
+    HWND hwnd = CreateWindowExW(exStyle, className, text, WS_CHILD | WS_VISIBLE | style,
+        0, 0, 0, 0, hwndParent, (HMENU)(INT_PTR)controlId, g_hInstance, NULL);
+    SendMessageW(hwnd, WM_SETFONT, (WPARAM)g_hFont, TRUE);
+    g_layoutHwnds[slot] = hwnd;
+    return hwnd;
+}
+
 void CreateControls(HWND hwndParent) {
-    int currentY = 10;
-    int margin = 10;
-    int controlHeight = 25;
-    int labelHeight = 20;
-    int gap = 5;
-    
-    RECT clientRect;
-    GetClientRect(hwndParent, &clientRect);
-    int windowWidth = clientRect.right - clientRect.left;
-    int editWidth = windowWidth - 2 * margin;
-    int labelWidth = editWidth;
-
-
-    g_hwndPrefixLabel = CreateWindowExW(0, L"STATIC", L"Command Prefix:",
-        WS_CHILD | WS_VISIBLE | SS_LEFT,
-        margin, currentY, labelWidth, labelHeight, hwndParent, (HMENU)IDC_STATIC_PREFIX_LABEL, g_hInstance, NULL);
-    SendMessageW(g_hwndPrefixLabel, WM_SETFONT, (WPARAM)g_hFont, TRUE);
-    currentY += labelHeight + gap;
-
-    g_hwndPrefixEdit = CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", g_initialCmdPrefix,
-        WS_CHILD | WS_VISIBLE | WS_BORDER | ES_AUTOHSCROLL | WS_TABSTOP,
-        margin, currentY, editWidth, controlHeight, hwndParent, (HMENU)IDC_EDIT_PREFIX, g_hInstance, NULL);
-    SendMessageW(g_hwndPrefixEdit, WM_SETFONT, (WPARAM)g_hFont, TRUE);
-    currentY += controlHeight + gap * 2;
-
-    g_hwndDashboardLabel = CreateWindowExW(0, L"STATIC", L"Dashboard:",
-        WS_CHILD | WS_VISIBLE | SS_LEFT,
-        margin, currentY, labelWidth, labelHeight, hwndParent, (HMENU)IDC_STATIC_DASHBOARD_LABEL, g_hInstance, NULL);
-    SendMessageW(g_hwndDashboardLabel, WM_SETFONT, (WPARAM)g_hFont, TRUE);
-    currentY += labelHeight + gap;
+    g_hwndPrefixLabel = CreateChildControl(hwndParent, SLOT_PREFIX_LABEL, 0, L"STATIC", L"Command Prefix (of the selected group):",
+        SS_LEFT, IDC_STATIC_PREFIX_LABEL);
+
+    g_hwndPrefixEdit = CreateChildControl(hwndParent, SLOT_PREFIX_EDIT, WS_EX_CLIENTEDGE, L"EDIT", g_scheduler.groups[g_selectedGroup].prefix,
+        WS_BORDER | ES_AUTOHSCROLL | WS_TABSTOP, IDC_EDIT_PREFIX);
+
+    g_hwndDashboardLabel = CreateChildControl(hwndParent, SLOT_DASHBOARD_LABEL, 0, L"STATIC", L"Dashboard:",
+        SS_LEFT, IDC_STATIC_DASHBOARD_LABEL);
 
     // Dashboard Display (Read-only Edit Control with Scrollbar)
-    int dashboardHeight = 80; // Increased height for dashboard
-    g_hwndDashboard = CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", L"", 
-        WS_CHILD | WS_VISIBLE | ES_MULTILINE | ES_AUTOVSCROLL | ES_READONLY | WS_VSCROLL | WS_TABSTOP,
-        margin, currentY, editWidth, dashboardHeight, hwndParent, (HMENU)IDC_STATIC_DASHBOARD, g_hInstance, NULL);
-    SendMessageW(g_hwndDashboard, WM_SETFONT, (WPARAM)g_hFont, TRUE);
-    currentY += dashboardHeight + gap * 2;
-
-    g_hwndLogLabel = CreateWindowExW(0, L"STATIC", L"Log Output:",
-        WS_CHILD | WS_VISIBLE | SS_LEFT,
-        margin, currentY, labelWidth, labelHeight, hwndParent, (HMENU)IDC_STATIC_LOG_LABEL, g_hInstance, NULL);
-    SendMessageW(g_hwndLogLabel, WM_SETFONT, (WPARAM)g_hFont, TRUE);
-    currentY += labelHeight + gap;
-
-    int logHeight = clientRect.bottom - currentY - controlHeight - gap * 3 - margin; 
-    if (logHeight < 50) logHeight = 50; 
-    g_hwndLog = CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", L"",
-        WS_CHILD | WS_VISIBLE | WS_VSCROLL | WS_HSCROLL | ES_MULTILINE | ES_AUTOVSCROLL | ES_AUTOHSCROLL | ES_READONLY | WS_TABSTOP,
-        margin, currentY, editWidth, logHeight, hwndParent, (HMENU)IDC_EDIT_LOG, g_hInstance, NULL);
-    SendMessageW(g_hwndLog, WM_SETFONT, (WPARAM)g_hFont, TRUE);
-    currentY += logHeight + gap * 2;
-
-    int suffixLabelWidth = 80;
-    g_hwndInputLabel = CreateWindowExW(0, L"STATIC", L"Cmd Suffix:",
-        WS_CHILD | WS_VISIBLE | SS_LEFT,
-        margin, currentY, suffixLabelWidth, labelHeight, hwndParent, (HMENU)IDC_STATIC_INPUT_LABEL, g_hInstance, NULL);
-    SendMessageW(g_hwndInputLabel, WM_SETFONT, (WPARAM)g_hFont, TRUE);
-
-    int buttonWidth = 100;
-    int suffixEditX = margin + suffixLabelWidth + gap;
-    int suffixEditWidth = editWidth - suffixLabelWidth - gap - buttonWidth - gap;
-    g_hwndInputEdit = CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", L"",
-        WS_CHILD | WS_VISIBLE | WS_BORDER | ES_AUTOHSCROLL | WS_TABSTOP,
-        suffixEditX, currentY, suffixEditWidth, controlHeight, hwndParent, (HMENU)IDC_EDIT_INPUT, g_hInstance, NULL);
-    SendMessageW(g_hwndInputEdit, WM_SETFONT, (WPARAM)g_hFont, TRUE);
-
-    int buttonX = suffixEditX + suffixEditWidth + gap;
-    g_hwndButtonAdd = CreateWindowExW(0, L"BUTTON", L"Add to Queue",
-        WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON | WS_TABSTOP, 
-        buttonX, currentY, buttonWidth, controlHeight, hwndParent, (HMENU)IDC_BUTTON_ADD, g_hInstance, NULL);
-    SendMessageW(g_hwndButtonAdd, WM_SETFONT, (WPARAM)g_hFont, TRUE);
+    g_hwndDashboard = CreateChildControl(hwndParent, SLOT_DASHBOARD, WS_EX_CLIENTEDGE, L"EDIT", L"",
+        ES_MULTILINE | ES_AUTOVSCROLL | ES_READONLY | WS_VSCROLL | WS_TABSTOP, IDC_STATIC_DASHBOARD);
+
+    g_hwndLogLabel = CreateChildControl(hwndParent, SLOT_LOG_LABEL, 0, L"STATIC", L"Log Output:",
+        SS_LEFT, IDC_STATIC_LOG_LABEL);
+
+    g_hwndLog = CreateChildControl(hwndParent, SLOT_LOG, WS_EX_CLIENTEDGE, L"EDIT", L"",
+        WS_VSCROLL | WS_HSCROLL | ES_MULTILINE | ES_AUTOVSCROLL | ES_AUTOHSCROLL | ES_READONLY | WS_TABSTOP, IDC_EDIT_LOG);
+
+    g_hwndGroupCombo = CreateChildControl(hwndParent, SLOT_GROUP_COMBO, 0, L"COMBOBOX", L"",
+        WS_VSCROLL | CBS_DROPDOWNLIST | WS_TABSTOP, IDC_COMBO_GROUP);
+    for (int i = 0; i < g_scheduler.group_count; ++i) {
+        SendMessageW(g_hwndGroupCombo, CB_ADDSTRING, 0, (LPARAM)g_scheduler.groups[i].name);
+    }
+    SendMessageW(g_hwndGroupCombo, CB_SETCURSEL, g_selectedGroup, 0);
+
+    g_hwndProfileCombo = CreateChildControl(hwndParent, SLOT_PROFILE_COMBO, 0, L"COMBOBOX", L"",
+        WS_VSCROLL | CBS_DROPDOWNLIST | WS_TABSTOP, IDC_COMBO_PROFILE);
+    for (int i = 0; i < g_profileCount; ++i) {
+        SendMessageW(g_hwndProfileCombo, CB_ADDSTRING, 0, (LPARAM)g_profiles[i].name);
+    }
+    SendMessageW(g_hwndProfileCombo, CB_SETCURSEL, 0, 0);
+
+    g_hwndInputLabel = CreateChildControl(hwndParent, SLOT_INPUT_LABEL, 0, L"STATIC", L"Cmd Suffix:",
+        SS_LEFT, IDC_STATIC_INPUT_LABEL);
+
+    g_hwndInputEdit = CreateChildControl(hwndParent, SLOT_INPUT_EDIT, WS_EX_CLIENTEDGE, L"EDIT", L"",
+        WS_BORDER | ES_AUTOHSCROLL | WS_TABSTOP, IDC_EDIT_INPUT);
 
+    g_hwndButtonAdd = CreateChildControl(hwndParent, SLOT_BUTTON_ADD, 0, L"BUTTON", L"Add to Queue",
+        BS_PUSHBUTTON | WS_TABSTOP, IDC_BUTTON_ADD);
+
+    g_hwndButtonExport = CreateChildControl(hwndParent, SLOT_BUTTON_EXPORT, 0, L"BUTTON", L"Export",
+        BS_PUSHBUTTON | WS_TABSTOP, IDC_BUTTON_EXPORT);
+
+    LayoutControls(hwndParent, TRUE);
     SetFocus(g_hwndInputEdit);
 }
 
+// Appends formatted text to the dashboard buffer; returns FALSE once it no longer fits.
+static BOOL AppendDashboardText(wchar_t* buffer, size_t bufferLen, size_t* used, const wchar_t* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = vswprintf(buffer + *used, bufferLen - *used, format, args);
+    va_end(args);
+    if (written < 0) {
+        buffer[*used] = L'\0'; // Drop the partial write
+        return FALSE;
+    }
+    *used += (size_t)written;
+    return TRUE;
+}
+
 void UpdateDashboardUI(void) {
     if (!g_hwndDashboard || !g_hwndMain) return;
 
     wchar_t dashboardText[8192]; // Increased buffer for dashboard display
+    const size_t textLen = sizeof(dashboardText) / sizeof(wchar_t);
+    size_t used = 0;
     dashboardText[0] = L'\0';    // Initialize to empty string
 
+    wchar_t runningCopy[WORKER_THREAD_COUNT][512];
     EnterCriticalSection(&g_dashboardLock);
-    wchar_t currentCmdCopy[sizeof(g_currentCommand) / sizeof(wchar_t)];
-    wcscpy_s(currentCmdCopy, sizeof(currentCmdCopy) / sizeof(wchar_t), g_currentCommand);
+    memcpy(runningCopy, g_workerCommands, sizeof(runningCopy));
     LeaveCriticalSection(&g_dashboardLock);
 
-    // Temporary storage for queue items to minimize time queueLock is held
-    QueuedTask tempQueueCopy[MAX_QUEUE_SIZE];
-    int tempQueueCount = 0;
+    // Copy group stats and the first queue items to minimize time queueLock is held
+    struct {
+        const wchar_t* name; // Fixed after startup
+        int queued, delayed, running, max_running, starts_per_minute;
+        TaskGroupStats stats;
+    } groupsCopy[MAX_TASK_GROUPS];
+    QueuedTask itemsCopy[MAX_DASHBOARD_ITEMS];
+    int itemCount = 0;
+    int totalQueued = 0;
 
     EnterCriticalSection(&g_queueLock);
-    int queueLen = g_queueCount;
-    if (queueLen > 0) {
-        int currentHead = g_queueHead;
-        for (int i = 0; i < queueLen; ++i) {
-            if (tempQueueCount >= MAX_QUEUE_SIZE) break; // Should not happen if queueLen is correct
-            int idx = (currentHead + i) % MAX_QUEUE_SIZE;
-            if (g_taskQueue[idx].prefix && g_taskQueue[idx].suffix) {
-                tempQueueCopy[tempQueueCount].prefix = _wcsdup(g_taskQueue[idx].prefix);
-                tempQueueCopy[tempQueueCount].suffix = _wcsdup(g_taskQueue[idx].suffix);
-                // Check if _wcsdup succeeded
-                if (tempQueueCopy[tempQueueCount].prefix && tempQueueCopy[tempQueueCount].suffix) {
-                    tempQueueCount++;
-                } else { // Free if one allocation failed but other succeeded
-                    if (tempQueueCopy[tempQueueCount].prefix) free(tempQueueCopy[tempQueueCount].prefix);
-                    if (tempQueueCopy[tempQueueCount].suffix) free(tempQueueCopy[tempQueueCount].suffix);
-                    tempQueueCopy[tempQueueCount].prefix = NULL; // Mark as invalid
-                    tempQueueCopy[tempQueueCount].suffix = NULL;
-                    // Optionally log an error here
-                }
+    int groupCount = g_scheduler.group_count;
+    for (int g = 0; g < groupCount; ++g) {
+        const TaskGroup* group = &g_scheduler.groups[g];
+        groupsCopy[g].name = group->name;
+        groupsCopy[g].queued = group->count;
+        groupsCopy[g].delayed = group->delayed_count;
+        groupsCopy[g].starts_per_minute = group->starts_per_minute;
+        groupsCopy[g].running = group->running;
+        groupsCopy[g].max_running = group->max_running;
+        groupsCopy[g].stats = group->stats;
+        totalQueued += group->count;
+
+        for (int i = 0; i < group->count && itemCount < MAX_DASHBOARD_ITEMS; ++i) {
+            const QueuedTask* queued = &group->queue[(group->head + i) % MAX_QUEUE_SIZE];
+            QueuedTask* item = &itemsCopy[itemCount];
+            item->prefix = _wcsdup(queued->prefix);
+            item->suffix = _wcsdup(queued->suffix);
+            item->group_index = g;
+            if (item->prefix && item->suffix) {
+                itemCount++;
+            } else { // Free if one allocation failed but other succeeded
+                free(item->prefix);
+                free(item->suffix);
             }
         }
     }
     LeaveCriticalSection(&g_queueLock);
 
-    // Format the dashboardText using the copied queue data
-    size_t currentTextLen = 0;
-    int written = swprintf(dashboardText, sizeof(dashboardText) / sizeof(wchar_t),
-                           L"Current CMD:\r\n%s\r\n\r\nQueue (%d pending):", currentCmdCopy, queueLen);
-    
-    if (written < 0) { // Error in swprintf or buffer too small for header
-        wcscpy_s(dashboardText, sizeof(dashboardText) / sizeof(wchar_t), L"Error generating dashboard header.");
-    } else {
-        currentTextLen = written;
+    int runningCount = 0;
+    for (int w = 0; w < WORKER_THREAD_COUNT; ++w) {
+        if (runningCopy[w][0]) runningCount++;
     }
 
-    if (queueLen == 0) {
-        const wchar_t* emptyMsg = L"\r\n[Empty]";
-        if (currentTextLen + wcslen(emptyMsg) < sizeof(dashboardText) / sizeof(wchar_t)) {
-            wcscat_s(dashboardText, sizeof(dashboardText) / sizeof(wchar_t), emptyMsg);
-        }
-    } else {
-        const wchar_t* rn = L"\r\n";
-        if (currentTextLen + wcslen(rn) < sizeof(dashboardText) / sizeof(wchar_t)) {
-            wcscat_s(dashboardText, sizeof(dashboardText) / sizeof(wchar_t), rn);
-            currentTextLen += wcslen(rn);
-        }
-
-        for (int i = 0; i < tempQueueCount; ++i) {
-            if (!tempQueueCopy[i].prefix || !tempQueueCopy[i].suffix) continue; // Skip if wcsdup failed
-
-            wchar_t singleItem[512 + 1024 + 30]; // prefix + space + suffix + numbering + \r\n + safety
-            written = swprintf(singleItem, sizeof(singleItem) / sizeof(wchar_t),
-                               L"%d. %s %s\r\n",
-                               i + 1,
-                               tempQueueCopy[i].prefix,
-                               tempQueueCopy[i].suffix);
+    BOOL fits = AppendDashboardText(dashboardText, textLen, &used, L"Running (%d of %d workers):\r\n", runningCount, WORKER_THREAD_COUNT);
+    if (runningCount == 0) fits = fits && AppendDashboardText(dashboardText, textLen, &used, L"Idle\r\n");
+    for (int w = 0; w < WORKER_THREAD_COUNT && fits; ++w) {
+        if (runningCopy[w][0]) fits = AppendDashboardText(dashboardText, textLen, &used, L"%s\r\n", runningCopy[w]);
+    }
 
-            if (written > 0) {
-                if (currentTextLen + (size_t)written < sizeof(dashboardText) / sizeof(wchar_t)) {
-                    wcscat_s(dashboardText, sizeof(dashboardText) / sizeof(wchar_t), singleItem);
-                    currentTextLen += written;
-                } else {
-                    const wchar_t* truncationMsg = L"... (queue list truncated)\r\n";
-                    if (currentTextLen + wcslen(truncationMsg) < sizeof(dashboardText) / sizeof(wchar_t)) {
-                        wcscat_s(dashboardText, sizeof(dashboardText) / sizeof(wchar_t), truncationMsg);
-                    }
-                    break; // Dashboard text buffer full
-                }
-            }
+    fits = fits && AppendDashboardText(dashboardText, textLen, &used, L"\r\nGroups:\r\n");
+    for (int g = 0; g < groupCount && fits; ++g) {
+        const TaskGroupStats* stats = &groupsCopy[g].stats;
+        double avgRun = stats->tasks_started ? stats->run_seconds_total / (double)stats->tasks_started : 0.0;
+        fits = AppendDashboardText(dashboardText, textLen, &used,
+            L"%s: %d queued, %d scheduled, %d/%d running, %llu done (%llu failed), %.1f MB out, avg %.1f s",
+            groupsCopy[g].name, groupsCopy[g].queued, groupsCopy[g].delayed, groupsCopy[g].running, groupsCopy[g].max_running,
+            stats->tasks_done, stats->tasks_failed, (double)stats->bytes_out / (1024.0 * 1024.0), avgRun);
+        if (fits && groupsCopy[g].starts_per_minute > 0) {
+            fits = AppendDashboardText(dashboardText, textLen, &used, L", max %d starts/min", groupsCopy[g].starts_per_minute);
         }
+        fits = fits && AppendDashboardText(dashboardText, textLen, &used, L"\r\n");
+    }
+
+    fits = fits && AppendDashboardText(dashboardText, textLen, &used, L"\r\nQueue (%d pending):\r\n", totalQueued);
+    if (totalQueued == 0) fits = fits && AppendDashboardText(dashboardText, textLen, &used, L"[Empty]");
+    for (int i = 0; i < itemCount && fits; ++i) {
+        wchar_t command[2048];
+        ExpandTaskCommand(itemsCopy[i].prefix, itemsCopy[i].suffix, command, sizeof(command)/sizeof(wchar_t));
+        fits = AppendDashboardText(dashboardText, textLen, &used, L"%d. [%s] %s\r\n",
+                                   i + 1, groupsCopy[itemsCopy[i].group_index].name, command);
+    }
+    if (fits && itemCount < totalQueued) {
+        fits = AppendDashboardText(dashboardText, textLen, &used, L"... and %d more\r\n", totalQueued - itemCount);
+    }
+    if (!fits) {
+        const wchar_t* truncationMsg = L"... (dashboard truncated)";
+        size_t truncationLen = wcslen(truncationMsg);
+        if (used + truncationLen >= textLen) used = textLen - truncationLen - 1;
+        wcscpy_s(dashboardText + used, textLen - used, truncationMsg);
     }
 
     SetWindowTextW(g_hwndDashboard, dashboardText);
 
     // Free duplicated strings
-    for (int i = 0; i < tempQueueCount; ++i) {
-        if (tempQueueCopy[i].prefix) free(tempQueueCopy[i].prefix);
-        if (tempQueueCopy[i].suffix) free(tempQueueCopy[i].suffix);
+    for (int i = 0; i < itemCount; ++i) {
+        free(itemsCopy[i].prefix);
+        free(itemsCopy[i].suffix);
     }
-    // For EDIT control, ensure it's scrolled to the top to show the "Current CMD" first
+    // For EDIT control, ensure it's scrolled to the top to show the running commands first
     SendMessageW(g_hwndDashboard, EM_SETSEL, (WPARAM)0, (LPARAM)0);
     SendMessageW(g_hwndDashboard, EM_SCROLLCARET, 0, 0);
 }
 
 
 // --- Command Queue & Processing ---
-void AddToQueue(const wchar_t* prefix, const wchar_t* suffix) {
+// Wakes the workers blocked in GetFromQueue as the scheduler asks. Caller holds g_queueLock.
+static void WakeWorkers(SchedulerWake wake) {
+    if (wake == SCHEDULER_WAKE_ALL) WakeAllConditionVariable(&g_queueNotEmpty);
+    else if (wake == SCHEDULER_WAKE_ONE) WakeConditionVariable(&g_queueNotEmpty);
+}
+
+void AddToQueue(const wchar_t* prefix, const wchar_t* suffix, int profileIndex, int groupIndex, ULONGLONG notBeforeMs) {
+    ULONGLONG nowUnixMs = UnixTimeMs(), nowTickMs = GetTickCount64();
+    ULONGLONG notBeforeUnixMs = notBeforeMs ? nowUnixMs + (notBeforeMs > nowTickMs ? notBeforeMs - nowTickMs : 0) : 0;
+    QueuedTask task = { _wcsdup(prefix), _wcsdup(suffix), profileIndex, groupIndex, notBeforeMs, nowUnixMs, notBeforeUnixMs };
+    // Check if _wcsdup succeeded
+    if (!task.prefix || !task.suffix) {
+        free(task.prefix);
+        free(task.suffix);
+        PostLogChunkToUI("Error: Memory allocation failed for new task.", TRUE, FALSE);
+        return;
+    }
+
     EnterCriticalSection(&g_queueLock);
+    SchedulerWake wake;
+    SchedulerAddResult added = SchedulerAdd(&g_scheduler, &task, GetTickCount64(), &wake);
+    WakeWorkers(wake);
+    LeaveCriticalSection(&g_queueLock);
 
-    if (g_queueCount < MAX_QUEUE_SIZE) {
-        g_taskQueue[g_queueTail].prefix = _wcsdup(prefix);
-        g_taskQueue[g_queueTail].suffix = _wcsdup(suffix);
-        // Check if _wcsdup succeeded
-        if (!g_taskQueue[g_queueTail].prefix || !g_taskQueue[g_queueTail].suffix) {
-            if (g_taskQueue[g_queueTail].prefix) free(g_taskQueue[g_queueTail].prefix);
-            if (g_taskQueue[g_queueTail].suffix) free(g_taskQueue[g_queueTail].suffix);
-            g_taskQueue[g_queueTail].prefix = NULL;
-            g_taskQueue[g_queueTail].suffix = NULL;
-            PostLogChunkToUI("Error: Memory allocation failed for new task.", TRUE, FALSE);
-        } else {
-            g_queueTail = (g_queueTail + 1) % MAX_QUEUE_SIZE;
-            g_queueCount++;
-            WakeConditionVariable(&g_queueNotEmpty);
+    if (added == SCHEDULER_QUEUED || added == SCHEDULER_DELAYED) return;
+    free(task.prefix);
+    free(task.suffix);
+    if (added == SCHEDULER_QUEUE_FULL) PostLogChunkToUI("Error: Command queue is full.", TRUE, FALSE);
+    else PostLogChunkToUI("Error: Memory allocation failed for new task.", TRUE, FALSE);
+}
+
+// Blocks until some group may start a task and dequeues it, counting it as running in
+// its group. Returns an empty task when the app is exiting. While waiting, the worker
+// sleeps exactly until the timer wheel next has something due, so scheduled tasks and
+// rate limits cost no polling however many there are. The task is published as the
+// worker's running task in the same step, so an export sees it either queued or running.
+QueuedTask GetFromQueue(int workerIndex) {
+    QueuedTask task = {0};
+    EnterCriticalSection(&g_queueLock);
+
+    while (!g_appExiting) {
+        ULONGLONG timeoutMs;
+        SchedulerWake wake;
+        int groupIndex = SchedulerTake(&g_scheduler, GetTickCount64(), &task, &timeoutMs, &wake);
+        WakeWorkers(wake);
+        if (groupIndex >= 0) {
+            EnterCriticalSection(&g_historyLock);
+            g_runningTasks[workerIndex].active = TRUE;
+            g_runningTasks[workerIndex].task = task;
+            g_runningTasks[workerIndex].started_unix_ms = UnixTimeMs();
+            LeaveCriticalSection(&g_historyLock);
+            break;
         }
-    } else {
-        PostLogChunkToUI("Error: Command queue is full.", TRUE, FALSE);
+
+        DWORD waitMs = (timeoutMs == TIMER_WHEEL_IDLE || timeoutMs >= INFINITE) ? INFINITE : (DWORD)timeoutMs;
+        SleepConditionVariableCS(&g_queueNotEmpty, &g_queueLock, waitMs);
     }
 
     LeaveCriticalSection(&g_queueLock);
+    return task;
 }
 
-QueuedTask GetFromQueue(void) {
-    QueuedTask task = {NULL, NULL};
+// Records a finished (or failed to start) task in its group and the run history, and
+// frees its running slot. The history takes ownership of record->command.
+void CompleteTask(TaskRecord* record, int workerIndex) {
     EnterCriticalSection(&g_queueLock);
+    TaskGroup* group = &g_scheduler.groups[record->group_index];
+    group->stats.tasks_done++;
+    if (record->started) group->stats.tasks_started++;
+    if (!record->started || record->exit_code != 0) group->stats.tasks_failed++;
+    group->stats.bytes_out += record->bytes_out;
+    group->stats.run_seconds_total += record->run_seconds;
+    WakeWorkers(SchedulerComplete(&g_scheduler, record->group_index));
+    LeaveCriticalSection(&g_queueLock);
 
-    while (g_queueCount == 0 && !g_appExiting) {
-        SleepConditionVariableCS(&g_queueNotEmpty, &g_queueLock, INFINITE);
+    EnterCriticalSection(&g_historyLock);
+    g_runningTasks[workerIndex].active = FALSE;
+    size_t chunk = g_historyCount / HISTORY_CHUNK_RECORDS;
+    if (chunk == g_historyChunkCapacity) {
+        size_t capacity = g_historyChunkCapacity ? g_historyChunkCapacity * 2 : 16;
+        TaskRecord** grown = (TaskRecord**)realloc(g_historyChunks, capacity * sizeof(TaskRecord*));
+        if (grown) {
+            memset(grown + g_historyChunkCapacity, 0, (capacity - g_historyChunkCapacity) * sizeof(TaskRecord*));
+            g_historyChunks = grown;
+            g_historyChunkCapacity = capacity;
+        }
     }
-
-    if (g_appExiting && g_queueCount == 0) { 
-        LeaveCriticalSection(&g_queueLock);
-        return task; 
+    if (chunk < g_historyChunkCapacity && !g_historyChunks[chunk]) {
+        g_historyChunks[chunk] = (TaskRecord*)malloc(HISTORY_CHUNK_RECORDS * sizeof(TaskRecord));
     }
-    
-    if (g_queueCount > 0) {
-        task = g_taskQueue[g_queueHead];
-        g_taskQueue[g_queueHead].prefix = NULL; 
-        g_taskQueue[g_queueHead].suffix = NULL;
-        g_queueHead = (g_queueHead + 1) % MAX_QUEUE_SIZE;
-        g_queueCount--;
+    if (chunk < g_historyChunkCapacity && g_historyChunks[chunk]) {
+        record->id = g_historyCount + 1;
+        g_historyChunks[chunk][g_historyCount % HISTORY_CHUNK_RECORDS] = *record;
+        g_historyCount++;
+        record->command = NULL;
     }
+    LeaveCriticalSection(&g_historyLock);
+    free(record->command); // Only set if the history could not grow
+}
 
-    LeaveCriticalSection(&g_queueLock);
-    return task;
+// LineSplitter sink for one pipe of a task.
+static void SubmitPipeLine(void* lineCtx, const char* line, int flags) {
+    PipeReaderContext* ctx = (PipeReaderContext*)lineCtx;
+    SubmitTaskLogLine(ctx->log, line, ctx->is_stderr, (flags & LINE_PROGRESS) != 0);
+    if (flags & LINE_PART) {
+        EnterCriticalSection(&ctx->log->lock);
+        if (!ctx->log->budget.long_line_reported) {
+            ctx->log->budget.long_line_reported = TRUE;
+            PostTaskLogLine(ctx->log->tag, "\xE2\x80\xA6 very long output line split into parts \xE2\x80\xA6", TRUE, FALSE);
+        }
+        LeaveCriticalSection(&ctx->log->lock);
+    }
 }
 
 DWORD WINAPI PipeReaderThread(LPVOID lpParam) {
-    HANDLE hPipeRead = (HANDLE)lpParam;
+    PipeReaderContext* ctx = (PipeReaderContext*)lpParam;
     char buffer[PIPE_BUFFER_SIZE];
     DWORD bytesRead;
-    BOOL isStdErr = FALSE; // TODO: This should be passed as part of lpParam if differentiation is needed.
-                           // For now, all pipe output is treated as non-stderr for color hints.
-
-    char partialLineBuffer[PIPE_BUFFER_SIZE * 2] = {0}; 
-    int partialLen = 0;
+    LineSplitter splitter;
+    LineSplitterInit(&splitter);
+
+    // The cancelled check runs before every read: a CancelSynchronousIo that arrives while
+    // this thread is elsewhere (e.g. waiting in SubmitTaskLogLine) would otherwise be lost.
+    while (!ctx->log->cancelled &&
+           ReadFile(ctx->pipe, buffer, sizeof(buffer), &bytesRead, NULL) && bytesRead > 0) {
+        LineSplitterFeed(&splitter, buffer, bytesRead, SubmitPipeLine, ctx);
+    }
+    LineSplitterFinish(&splitter, SubmitPipeLine, ctx);
+    return 0;
+}
 
-    while (ReadFile(hPipeRead, buffer, sizeof(buffer) - 1, &bytesRead, NULL) && bytesRead > 0) {
-        buffer[bytesRead] = '\0'; 
 
-        if (partialLen + bytesRead < sizeof(partialLineBuffer)) {
-            // Using strncat_s or similar would be safer if buffer could contain nulls before bytesRead
-            strcat_s(partialLineBuffer, sizeof(partialLineBuffer), buffer);
-            partialLen += bytesRead;
-        } else {
-            PostLogChunkToUI("Pipe reader buffer overflow (partial line).", TRUE, FALSE); 
-            // Process what's there, then copy the new buffer content, possibly losing middle part.
-            // A more robust way would be to process partialLineBuffer, then process `buffer` directly.
-            // For simplicity, we might just clear and restart with `buffer`.
-            if (strlen(buffer) < sizeof(partialLineBuffer)) {
-                strcpy_s(partialLineBuffer, sizeof(partialLineBuffer), buffer);
-                partialLen = strlen(buffer);
-            } else {
-                 partialLineBuffer[0] = '\0'; // Cannot fit, discard
-                 partialLen = 0;
-                 PostLogChunkToUI("Pipe reader new chunk too large after overflow.", TRUE, FALSE);
-            }
-        }
-        
-        char* lineStart = partialLineBuffer;
-        char* lineEnd;
+// --- Log Budget ---
+void InitTaskLog(TaskLog* log, const TaskLogTag* tag) {
+    InitializeCriticalSection(&log->lock);
+    log->tag = tag;
+    TaskLogBudgetInit(&log->budget, GetTickCount64());
+    log->cancelled = 0;
+}
 
-        while ((lineEnd = strpbrk(lineStart, "\r\n")) != NULL) {
-            BOOL isProgress = (*lineEnd == '\r' && *(lineEnd + 1) != '\n' && *(lineEnd + 1) != '\0');
-            *lineEnd = '\0'; 
+void FreeTaskLog(TaskLog* log) {
+    TaskLogBudgetFree(&log->budget);
+    DeleteCriticalSection(&log->lock);
+}
 
-            PostLogChunkToUI(lineStart, isStdErr, isProgress);
+// Posts the "lines suppressed" summary. Caller holds log->lock.
+static void ReportSuppressedLines(TaskLog* log, ULONGLONG now) {
+    ULONGLONG suppressedLines, suppressedBytes;
+    if (!TaskLogBudgetTakeReport(&log->budget, now, &suppressedLines, &suppressedBytes)) return;
+    wchar_t lines[32], bytes[32], msg[128];
+    FormatCount(lines, sizeof(lines)/sizeof(wchar_t), suppressedLines);
+    FormatCount(bytes, sizeof(bytes)/sizeof(wchar_t), suppressedBytes);
+    swprintf(msg, sizeof(msg)/sizeof(wchar_t), L"\x2026 %s lines suppressed (%s bytes) \x2026", lines, bytes);
+    PostTaskLogLine_Wide(log->tag, msg, FALSE, FALSE);
+}
 
-            lineStart = lineEnd + 1; 
-            if (*lineEnd == '\r' && *lineStart == '\n') { // Handle CRLF
-                 lineStart++;
-            }
-        }
-        
-        if (*lineStart != '\0') {
-            strcpy_s(partialLineBuffer, sizeof(partialLineBuffer), lineStart);
-            partialLen = strlen(partialLineBuffer);
-        } else {
-            partialLineBuffer[0] = '\0';
-            partialLen = 0;
-        }
+// Called by the pipe readers for every complete line; TaskLogBudgetSubmit decides what
+// reaches the UI. When the UI falls behind, the reader sleeps here until LogChunkDone
+// wakes it, which stops it draining the pipe and in turn blocks the child on write.
+void SubmitTaskLogLine(TaskLog* log, const char* line, BOOL isStdErr, BOOL isProgress) {
+    EnterCriticalSection(&log->lock);
+    ULONGLONG now = GetTickCount64();
+    TaskLogDecision decision = TaskLogBudgetSubmit(&log->budget, line, isProgress, now);
+    if (decision.budget_exhausted) {
+        PostTaskLogLine(log->tag, "\xE2\x80\xA6 log budget for this task reached, further output is only counted \xE2\x80\xA6", TRUE, FALSE);
     }
-    
-    if (partialLen > 0) {
-        PostLogChunkToUI(partialLineBuffer, isStdErr, FALSE);
+    LeaveCriticalSection(&log->lock);
+
+    if (!decision.show && !decision.report_due) return;
+
+    EnterCriticalSection(&g_logRoomLock);
+    while (g_pendingLogChunks >= MAX_PENDING_LOG_CHUNKS && !g_appExiting && !log->cancelled) {
+        SleepConditionVariableCS(&g_logRoom, &g_logRoomLock, INFINITE);
     }
+    LeaveCriticalSection(&g_logRoomLock);
 
-    return 0;
+    EnterCriticalSection(&log->lock);
+    if (decision.report_due) ReportSuppressedLines(log, now);
+    if (decision.show) PostTaskLogLine(log->tag, line, isStdErr, isProgress);
+    LeaveCriticalSection(&log->lock);
+}
+
+// Emits what is still held back once both readers are done: the last progress line and
+// the final summary. The totals stay readable in the budget afterwards.
+void FlushTaskLog(TaskLog* log) {
+    EnterCriticalSection(&log->lock);
+    char* progress = TaskLogBudgetTakePendingProgress(&log->budget);
+    if (progress) {
+        PostTaskLogLine(log->tag, progress, FALSE, TRUE);
+        free(progress);
+    }
+    ReportSuppressedLines(log, GetTickCount64());
+    LeaveCriticalSection(&log->lock);
 }
 
 
 DWORD WINAPI CommandProcessorThread(LPVOID lpParam) {
+    int workerIndex = (int)(INT_PTR)lpParam;
+    ProcessLauncher launcher;
+    // A worker without a launcher would leave its share of the queue unserved, so keep
+    // retrying (the allocation only fails under memory pressure) until it works or we exit.
+    BOOL launcherReported = FALSE;
+    while (!InitProcessLauncher(&launcher, g_hNulInput)) {
+        if (!launcherReported) {
+            PostLogChunkToUI("Error: Could not allocate process attribute list, retrying.", TRUE, FALSE);
+            launcherReported = TRUE;
+        }
+        if (g_appExiting) return 1;
+        Sleep(1000);
+    }
+
+    LARGE_INTEGER qpcFreq;
+    QueryPerformanceFrequency(&qpcFreq);
+
     while (!g_appExiting) {
-        QueuedTask task = GetFromQueue();
+        QueuedTask task = GetFromQueue(workerIndex);
         if (g_appExiting && (task.prefix == NULL || task.suffix == NULL)) { 
              if (task.prefix) free(task.prefix);
              if (task.suffix) free(task.suffix);
@@ -626,110 +989,568 @@ DWORD WINAPI CommandProcessorThread(LPVOID lpParam) {
         }
         if (task.prefix == NULL || task.suffix == NULL) continue; 
 
+        const wchar_t* groupName = g_scheduler.groups[task.group_index].name;
         wchar_t fullCmdLine[2048];
-        swprintf(fullCmdLine, sizeof(fullCmdLine)/sizeof(wchar_t), L"%s %s", task.prefix, task.suffix);
+        ExpandTaskCommand(task.prefix, task.suffix, fullCmdLine, sizeof(fullCmdLine)/sizeof(wchar_t));
 
         EnterCriticalSection(&g_dashboardLock);
-        wcscpy_s(g_currentCommand, sizeof(g_currentCommand)/sizeof(wchar_t), fullCmdLine);
+        swprintf(g_workerCommands[workerIndex], sizeof(g_workerCommands[workerIndex])/sizeof(wchar_t), L"[%s] %s", groupName, fullCmdLine);
         LeaveCriticalSection(&g_dashboardLock);
         PostMessage(g_hwndMain, WM_APP_UPDATE_DASHBOARD, 0, 0);
 
+        TaskLogTag logTag;
+        logTag.task_id = InterlockedIncrement(&g_lastLogTaskId);
+        swprintf(logTag.tag, sizeof(logTag.tag)/sizeof(wchar_t), L"[%s #%ld]", groupName, logTag.task_id);
         wchar_t logMsg[2100];
         swprintf(logMsg, sizeof(logMsg)/sizeof(wchar_t), L"$ %s", fullCmdLine);
-        PostLogChunkToUI_Wide(logMsg, FALSE, TRUE); 
-
-        STARTUPINFOW si = {0};
-        PROCESS_INFORMATION pi = {0};
-        SECURITY_ATTRIBUTES sa = {0};
-
-        si.cb = sizeof(STARTUPINFOW);
-        si.dwFlags |= STARTF_USESTDHANDLES;
-        
-        sa.nLength = sizeof(SECURITY_ATTRIBUTES);
-        sa.bInheritHandle = TRUE;
-        sa.lpSecurityDescriptor = NULL;
+        PostTaskLogLine_Wide(&logTag, logMsg, FALSE, FALSE);
 
+        const LaunchProfile* profile = &g_profiles[task.profile_index];
         HANDLE hChildStd_OUT_Rd = NULL;
-        HANDLE hChildStd_OUT_Wr = NULL;
         HANDLE hChildStd_ERR_Rd = NULL;
-        HANDLE hChildStd_ERR_Wr = NULL;
-
-        // Create pipes for stdout
-        if (!CreatePipe(&hChildStd_OUT_Rd, &hChildStd_OUT_Wr, &sa, 0)) {
-            PostLogChunkToUI_Wide(L"CreatePipe (stdout) failed.", TRUE, FALSE);
-            goto cleanup_task;
-        }
-        if (!SetHandleInformation(hChildStd_OUT_Rd, HANDLE_FLAG_INHERIT, 0)) { // Read handle is not inherited
-            PostLogChunkToUI_Wide(L"SetHandleInformation (stdout_rd) failed.", TRUE, FALSE);
-            CloseHandle(hChildStd_OUT_Rd); CloseHandle(hChildStd_OUT_Wr);
-            goto cleanup_task;
-        }
-        si.hStdOutput = hChildStd_OUT_Wr;
-
-        // Create pipes for stderr
-        if (!CreatePipe(&hChildStd_ERR_Rd, &hChildStd_ERR_Wr, &sa, 0)) {
-            PostLogChunkToUI_Wide(L"CreatePipe (stderr) failed.", TRUE, FALSE);
-            CloseHandle(hChildStd_OUT_Rd); CloseHandle(hChildStd_OUT_Wr);
-            goto cleanup_task;
-        }
-        if (!SetHandleInformation(hChildStd_ERR_Rd, HANDLE_FLAG_INHERIT, 0)) { // Read handle is not inherited
-            PostLogChunkToUI_Wide(L"SetHandleInformation (stderr_rd) failed.", TRUE, FALSE);
-            CloseHandle(hChildStd_OUT_Rd); CloseHandle(hChildStd_OUT_Wr);
-            CloseHandle(hChildStd_ERR_Rd); CloseHandle(hChildStd_ERR_Wr);
-            goto cleanup_task;
-        }
-        si.hStdError = hChildStd_ERR_Wr;
-        
-        si.hStdInput = GetStdHandle(STD_INPUT_HANDLE); // Or NULL if no input redirection
-
-        BOOL success = CreateProcessW(
-            NULL, fullCmdLine, NULL, NULL, TRUE, 
-            CREATE_NO_WINDOW, NULL, NULL, &si, &pi );
-
-        // After CreateProcess, parent must close its write ends of pipes
-        // so ReadFile on read ends will break when child closes its write ends.
-        CloseHandle(hChildStd_OUT_Wr); hChildStd_OUT_Wr = NULL; // Mark as closed
-        CloseHandle(hChildStd_ERR_Wr); hChildStd_ERR_Wr = NULL; // Mark as closed
+        PROCESS_INFORMATION pi = {0};
+        TaskRecord record = {0};
+        record.group_index = task.group_index;
+        record.profile_index = task.profile_index;
+        record.command = _wcsdup(fullCmdLine);
+        record.enqueued_unix_ms = task.enqueued_unix_ms;
+        record.not_before_unix_ms = task.not_before_unix_ms;
+        record.started_unix_ms = g_runningTasks[workerIndex].started_unix_ms; // Only this worker writes its slot
+
+        LARGE_INTEGER launchStart, launchEnd, runEnd;
+        QueryPerformanceCounter(&launchStart);
+        BOOL success = LaunchChildProcess(&launcher, fullCmdLine, profile->working_dir, profile->env_block,
+                                          &hChildStd_OUT_Rd, &hChildStd_ERR_Rd, &pi);
+        DWORD launchError = success ? 0 : GetLastError();
+        QueryPerformanceCounter(&launchEnd);
+        record.launch_ms = (double)(launchEnd.QuadPart - launchStart.QuadPart) * 1000.0 / (double)qpcFreq.QuadPart;
 
         if (success) {
-            // TODO: Pass struct to PipeReaderThread to indicate if it's for stderr
-            HANDLE hStdOutReader = CreateThread(NULL, 0, PipeReaderThread, hChildStd_OUT_Rd, 0, NULL);
-            HANDLE hStdErrReader = CreateThread(NULL, 0, PipeReaderThread, hChildStd_ERR_Rd, 0, NULL);
+            TaskLog taskLog;
+            InitTaskLog(&taskLog, &logTag);
+            PipeReaderContext outCtx = { hChildStd_OUT_Rd, FALSE, &taskLog };
+            PipeReaderContext errCtx = { hChildStd_ERR_Rd, TRUE, &taskLog };
+            HANDLE hStdOutReader = CreateThread(NULL, 0, PipeReaderThread, &outCtx, 0, NULL);
+            HANDLE hStdErrReader = CreateThread(NULL, 0, PipeReaderThread, &errCtx, 0, NULL);
             // If CreateThread fails, hStdOutReader/hStdErrReader will be NULL.
 
             WaitForSingleObject(pi.hProcess, INFINITE);
+            QueryPerformanceCounter(&runEnd);
             
             DWORD exitCode;
             GetExitCodeProcess(pi.hProcess, &exitCode);
             
-            if(hStdOutReader) { WaitForSingleObject(hStdOutReader, 5000); CloseHandle(hStdOutReader); }
-            if(hStdErrReader) { WaitForSingleObject(hStdErrReader, 5000); CloseHandle(hStdErrReader); }
-
-            wchar_t exitMsg[100];
-            swprintf(exitMsg, sizeof(exitMsg)/sizeof(wchar_t), L"Process finished. Exit code: %lu", exitCode);
-            PostLogChunkToUI_Wide(exitMsg, FALSE, TRUE);
+            // The readers hold pointers into this frame, so they must be gone before it unwinds.
+            // A grandchild can keep the pipe open after the child exits. Then flag the task
+            // cancelled and keep cancelling: a single CancelSynchronousIo is lost if the reader
+            // is not inside ReadFile at that moment, but the flag stops its next read.
+            HANDLE readers[2];
+            DWORD readerCount = 0;
+            if (hStdOutReader) readers[readerCount++] = hStdOutReader;
+            if (hStdErrReader) readers[readerCount++] = hStdErrReader;
+            if (readerCount > 0 && WaitForMultipleObjects(readerCount, readers, TRUE, 5000) == WAIT_TIMEOUT) {
+                InterlockedExchange(&taskLog.cancelled, 1);
+                do {
+                    WakeLogWriters(); // In case a reader waits for the UI rather than in ReadFile
+                    for (DWORD r = 0; r < readerCount; ++r) CancelSynchronousIo(readers[r]);
+                } while (WaitForMultipleObjects(readerCount, readers, TRUE, 100) == WAIT_TIMEOUT);
+            }
+            if (hStdOutReader) CloseHandle(hStdOutReader);
+            if (hStdErrReader) CloseHandle(hStdErrReader);
+            FlushTaskLog(&taskLog);
+
+            record.started = TRUE;
+            record.exit_code = exitCode;
+            record.run_seconds = (double)(runEnd.QuadPart - launchEnd.QuadPart) / (double)qpcFreq.QuadPart;
+            record.bytes_out = taskLog.budget.bytes_total;
+            record.lines_out = taskLog.budget.lines_total;
+            record.lines_suppressed = taskLog.budget.suppressed_lines_total;
+            wchar_t lineCount[32], byteCount[32], exitMsg[256];
+            FormatCount(lineCount, sizeof(lineCount)/sizeof(wchar_t), taskLog.budget.lines_total);
+            FormatCount(byteCount, sizeof(byteCount)/sizeof(wchar_t), taskLog.budget.bytes_total);
+            swprintf(exitMsg, sizeof(exitMsg)/sizeof(wchar_t),
+                     L"Process finished. Exit code: %lu (launch %.2f ms, run %.2f s, %s lines, %s bytes)",
+                     exitCode, record.launch_ms, record.run_seconds, lineCount, byteCount);
+            PostTaskLogLine_Wide(&logTag, exitMsg, FALSE, FALSE);
+            FreeTaskLog(&taskLog);
 
             CloseHandle(pi.hProcess);
             CloseHandle(pi.hThread);
+            CloseHandle(hChildStd_OUT_Rd); 
+            CloseHandle(hChildStd_ERR_Rd);
         } else {
-            wchar_t errorMsg[256];
-            swprintf(errorMsg, sizeof(errorMsg)/sizeof(wchar_t), L"Error starting command: %s (Code: %lu)", fullCmdLine, GetLastError());
-            PostLogChunkToUI_Wide(errorMsg, TRUE, TRUE);
+            wchar_t errorMsg[2200];
+            swprintf(errorMsg, sizeof(errorMsg)/sizeof(wchar_t), L"Error starting command: %s (Code: %lu)", fullCmdLine, launchError);
+            PostTaskLogLine_Wide(&logTag, errorMsg, TRUE, FALSE);
+            record.exit_code = launchError;
         }
 
-        CloseHandle(hChildStd_OUT_Rd); 
-        CloseHandle(hChildStd_ERR_Rd);
-
-cleanup_task:
+        record.finished_unix_ms = UnixTimeMs();
+        CompleteTask(&record, workerIndex);
         free(task.prefix);
         free(task.suffix);
-        PostMessage(g_hwndMain, WM_APP_COMMAND_DONE, 0, 0); 
+        // Cleared here rather than by the UI thread, which could otherwise wipe the next
+        // task's command if this worker got to it first.
+        EnterCriticalSection(&g_dashboardLock);
+        g_workerCommands[workerIndex][0] = L'\0';
+        LeaveCriticalSection(&g_dashboardLock);
+        PostMessage(g_hwndMain, WM_APP_COMMAND_DONE, (WPARAM)workerIndex, 0); 
     }
+
+    FreeProcessLauncher(&launcher);
     return 0;
 }
 
 
+// --- Launch Profiles ---
+// CreateProcessW wants a full path for the working directory; resolve relative ones
+// against ours now rather than fail every launch of the profile.
+static wchar_t* FullPathName(const wchar_t* path) {
+    DWORD needed = GetFullPathNameW(path, 0, NULL, NULL);
+    wchar_t* full = needed ? (wchar_t*)malloc(needed * sizeof(wchar_t)) : NULL;
+    DWORD length = full ? GetFullPathNameW(path, needed, full, NULL) : 0;
+    if (length > 0 && length < needed) return full;
+    free(full);
+    return _wcsdup(path);
+}
+
+void ParseCommandLineArgs(void) {
+    AddLaunchProfile(DEFAULT_PROFILE_NAME);
+    AddTaskGroup(L"Audio", DEFAULT_CMD_PREFIX, 2);
+    AddTaskGroup(L"Video", DEFAULT_VIDEO_PREFIX, 1);
+    AddTaskGroup(L"Command", TASK_SUFFIX_PLACEHOLDER, 2);
+
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv) return;
+
+    // --profile NAME starts a new profile; --cwd and --env apply to the most recent one.
+    // --group NAME selects (or creates) a group; --prefix, --max-running, --weight,
+    // --starts-per-minute and --start-burst apply to it.
+    LaunchProfile* current = &g_profiles[0];
+    TaskGroup* currentGroup = &g_scheduler.groups[0];
+    for (int i = 1; i < argc; ++i) {
+        BOOL hasValue = (i + 1 < argc);
+        if (wcscmp(argv[i], L"--prefix") == 0 && hasValue) {
+            wchar_t* prefix = _wcsdup(argv[++i]);
+            if (prefix) { free(currentGroup->prefix); currentGroup->prefix = prefix; }
+        } else if (wcscmp(argv[i], L"--group") == 0 && hasValue) {
+            TaskGroup* group = FindTaskGroup(argv[++i]);
+            if (!group) group = AddTaskGroup(argv[i], TASK_SUFFIX_PLACEHOLDER, 1); // Raw commands until --prefix
+            if (group) currentGroup = group;
+        } else if (wcscmp(argv[i], L"--max-running") == 0 && hasValue) {
+            int value = _wtoi(argv[++i]);
+            if (value > WORKER_THREAD_COUNT) {
+                // More than the worker pool can run at once would silently do nothing
+                wchar_t msg[160];
+                swprintf(msg, sizeof(msg)/sizeof(wchar_t), L"--max-running %d for %s exceeds the %d workers, using %d.",
+                         value, currentGroup->name, WORKER_THREAD_COUNT, WORKER_THREAD_COUNT);
+                PostLogChunkToUI_Wide(msg, TRUE, FALSE);
+                value = WORKER_THREAD_COUNT;
+            }
+            if (value > 0) currentGroup->max_running = value;
+        } else if (wcscmp(argv[i], L"--weight") == 0 && hasValue) {
+            int value = _wtoi(argv[++i]);
+            if (value > 0) currentGroup->quantum = value;
+        } else if (wcscmp(argv[i], L"--starts-per-minute") == 0 && hasValue) {
+            int value = _wtoi(argv[++i]);
+            if (value >= 0) currentGroup->starts_per_minute = value;
+        } else if (wcscmp(argv[i], L"--start-burst") == 0 && hasValue) {
+            int value = _wtoi(argv[++i]);
+            if (value > 0) {
+                currentGroup->start_burst = value;
+                currentGroup->start_tokens = value;
+            }
+        } else if (wcscmp(argv[i], L"--profile") == 0 && hasValue) {
+            LaunchProfile* profile = AddLaunchProfile(argv[++i]);
+            if (profile) current = profile;
+        } else if (wcscmp(argv[i], L"--cwd") == 0 && hasValue) {
+            free(current->working_dir);
+            current->working_dir = FullPathName(argv[++i]);
+        } else if (wcscmp(argv[i], L"--env") == 0 && hasValue) {
+            AddProfileEnvOverride(current, argv[++i]);
+        }
+    }
+    LocalFree(argv);
+}
+
+LaunchProfile* AddLaunchProfile(const wchar_t* name) {
+    if (g_profileCount >= MAX_LAUNCH_PROFILES) return NULL;
+    LaunchProfile* profile = &g_profiles[g_profileCount++];
+    memset(profile, 0, sizeof(*profile));
+    wcsncpy_s(profile->name, sizeof(profile->name)/sizeof(wchar_t), name, _TRUNCATE);
+    return profile;
+}
+
+BOOL AddProfileEnvOverride(LaunchProfile* profile, const wchar_t* assignment) {
+    if (assignment[0] == L'\0' || !wcschr(assignment + 1, L'=')) return FALSE; // Needs NAME=VALUE (a leading '=' is part of the name)
+    size_t len = wcslen(assignment);
+    // Room for the new entry, its terminator and the block's final terminator.
+    wchar_t* grown = (wchar_t*)realloc(profile->env_overrides, (profile->env_overrides_len + len + 2) * sizeof(wchar_t));
+    if (!grown) return FALSE;
+    memcpy(grown + profile->env_overrides_len, assignment, (len + 1) * sizeof(wchar_t));
+    profile->env_overrides = grown;
+    profile->env_overrides_len += len + 1;
+    profile->env_overrides[profile->env_overrides_len] = L'\0';
+    return TRUE;
+}
+
+static size_t EnvNameLength(const wchar_t* entry) {
+    const wchar_t* eq = wcschr(entry + 1, L'='); // Skip a leading '=' of "=C:=C:\dir" entries
+    return eq ? (size_t)(eq - entry) : wcslen(entry);
+}
+
+// Case-insensitive comparison of the variable names, the order CreateProcessW expects.
+static int EnvCompareNames(const wchar_t* a, const wchar_t* b) {
+    int result = CompareStringOrdinal(a, (int)EnvNameLength(a), b, (int)EnvNameLength(b), TRUE);
+    return result == CSTR_LESS_THAN ? -1 : result == CSTR_GREATER_THAN ? 1 : 0;
+}
+
+static int EnvCompareEntries(const void* a, const void* b) {
+    return EnvCompareNames(*(const wchar_t* const*)a, *(const wchar_t* const*)b);
+}
+
+// Returns the last override for entry's name (later --env options win), or NULL.
+static const wchar_t* EnvFindOverride(const wchar_t* overrides, const wchar_t* entry) {
+    const wchar_t* found = NULL;
+    for (const wchar_t* o = overrides; *o; o += wcslen(o) + 1) {
+        if (EnvCompareNames(o, entry) == 0) found = o;
+    }
+    return found;
+}
+
+// Merges our environment with the overrides into a block for CreateProcessW, sorted by
+// name as environment blocks must be. Built once per profile at startup, so launches pay
+// nothing for it.
+wchar_t* BuildEnvironmentBlock(const wchar_t* overrides) {
+    wchar_t* parent = GetEnvironmentStringsW();
+    if (!parent) return NULL;
+
+    size_t entryCount = 0, chars = 0;
+    for (const wchar_t* e = parent; *e; e += wcslen(e) + 1) { entryCount++; chars += wcslen(e) + 1; }
+    for (const wchar_t* o = overrides; *o; o += wcslen(o) + 1) { entryCount++; chars += wcslen(o) + 1; }
+
+    const wchar_t** entries = (const wchar_t**)malloc((entryCount ? entryCount : 1) * sizeof(wchar_t*));
+    wchar_t* block = (wchar_t*)malloc((chars + 2) * sizeof(wchar_t));
+    if (!entries || !block) {
+        free(entries);
+        free(block);
+        FreeEnvironmentStringsW(parent);
+        return NULL;
+    }
+
+    size_t n = 0;
+    for (const wchar_t* e = parent; *e; e += wcslen(e) + 1) {
+        if (!EnvFindOverride(overrides, e)) entries[n++] = e;
+    }
+    for (const wchar_t* o = overrides; *o; o += wcslen(o) + 1) {
+        if (EnvFindOverride(overrides, o) != o) continue; // Replaced by a later --env
+        if (o[EnvNameLength(o) + 1] == L'\0') continue;  // "NAME=" only removes the variable
+        entries[n++] = o;
+    }
+    qsort(entries, n, sizeof(wchar_t*), EnvCompareEntries);
+
+    wchar_t* out = block;
+    for (size_t i = 0; i < n; ++i) {
+        size_t len = wcslen(entries[i]) + 1;
+        memcpy(out, entries[i], len * sizeof(wchar_t));
+        out += len;
+    }
+    if (out == block) *out++ = L'\0'; // An empty block still needs two terminators
+    *out = L'\0';
+
+    free(entries);
+    FreeEnvironmentStringsW(parent);
+    return block;
+}
+
+void FreeLaunchProfiles(void) {
+    for (int i = 0; i < g_profileCount; ++i) {
+        free(g_profiles[i].working_dir);
+        free(g_profiles[i].env_overrides);
+        free(g_profiles[i].env_block);
+    }
+    g_profileCount = 0;
+}
+
+
+// --- Task Groups ---
+TaskGroup* AddTaskGroup(const wchar_t* name, const wchar_t* prefix, int maxRunning) {
+    wchar_t* prefixCopy = _wcsdup(prefix);
+    if (!prefixCopy) return NULL;
+    TaskGroup* group = SchedulerAddGroup(&g_scheduler, maxRunning, GetTickCount64());
+    if (!group) {
+        free(prefixCopy);
+        return NULL;
+    }
+    group->prefix = prefixCopy;
+    wcsncpy_s(group->name, sizeof(group->name)/sizeof(wchar_t), name, _TRUNCATE);
+    return group;
+}
+
+TaskGroup* FindTaskGroup(const wchar_t* name) {
+    for (int i = 0; i < g_scheduler.group_count; ++i) {
+        if (_wcsicmp(g_scheduler.groups[i].name, name) == 0) return &g_scheduler.groups[i];
+    }
+    return NULL;
+}
+
+void FreeTaskGroups(void) {
+    SchedulerFree(&g_scheduler);
+    for (int g = 0; g < g_scheduler.group_count; ++g) free(g_scheduler.groups[g].prefix);
+    g_scheduler.group_count = 0;
+}
+
+// Builds the command line for a task: every TASK_SUFFIX_PLACEHOLDER in the prefix is
+// replaced by the suffix; without one the suffix is appended after a space.
+void ExpandTaskCommand(const wchar_t* prefix, const wchar_t* suffix, wchar_t* out, size_t outLen) {
+    const size_t placeholderLen = wcslen(TASK_SUFFIX_PLACEHOLDER);
+    if (!wcsstr(prefix, TASK_SUFFIX_PLACEHOLDER)) {
+        swprintf(out, outLen, L"%s %s", prefix, suffix);
+        return;
+    }
+    size_t used = 0;
+    const wchar_t* p = prefix;
+    const wchar_t* hit;
+    out[0] = L'\0';
+    while ((hit = wcsstr(p, TASK_SUFFIX_PLACEHOLDER)) != NULL) {
+        int written = swprintf(out + used, outLen - used, L"%.*s%s", (int)(hit - p), p, suffix);
+        if (written < 0) return; // Truncated, keep what fit before
+        used += (size_t)written;
+        p = hit + placeholderLen;
+    }
+    if (swprintf(out + used, outLen - used, L"%s", p) < 0) out[used] = L'\0';
+}
+
+// Strips a leading "+N[s|m|h]" (default minutes) or "@HH:MM" (next such local time) token
+// from suffix and returns how long the task should wait. Anything else is left alone.
+BOOL ParseScheduleDirective(wchar_t* suffix, ULONGLONG* delayMs) {
+    wchar_t* end = NULL;
+    if (suffix[0] == L'+' && iswdigit(suffix[1])) {
+        unsigned long amount = wcstoul(suffix + 1, &end, 10);
+        ULONGLONG unitMs = 60000;
+        if (*end == L's') { unitMs = 1000; end++; }
+        else if (*end == L'm') { end++; }
+        else if (*end == L'h') { unitMs = 3600000; end++; }
+        if (*end && !iswspace(*end)) return FALSE;
+        *delayMs = (ULONGLONG)amount * unitMs;
+    } else if (suffix[0] == L'@' && iswdigit(suffix[1])) {
+        unsigned long hour = wcstoul(suffix + 1, &end, 10);
+        if (*end != L':' || !iswdigit(end[1])) return FALSE;
+        unsigned long minute = wcstoul(end + 1, &end, 10);
+        if (hour > 23 || minute > 59 || (*end && !iswspace(*end))) return FALSE;
+
+        SYSTEMTIME now;
+        GetLocalTime(&now);
+        const LONGLONG dayMs = 24LL * 3600000;
+        LONGLONG nowMs = ((now.wHour * 60LL + now.wMinute) * 60 + now.wSecond) * 1000 + now.wMilliseconds;
+        LONGLONG waitMs = (LONGLONG)(hour * 60 + minute) * 60000 - nowMs;
+        if (waitMs <= 0) waitMs += dayMs; // Already past today: tomorrow
+        *delayMs = (ULONGLONG)waitMs;
+    } else {
+        return FALSE;
+    }
+
+    while (*end && iswspace(*end)) end++;
+    memmove(suffix, end, (wcslen(end) + 1) * sizeof(wchar_t));
+    return TRUE;
+}
+
+// Shows the prefix of groupIndex in the prefix edit, keeping edits made to the previous group.
+void SelectTaskGroup(int groupIndex) {
+    wchar_t prefix_buffer[512];
+    GetWindowTextW(g_hwndPrefixEdit, prefix_buffer, sizeof(prefix_buffer)/sizeof(wchar_t));
+    TaskGroup* previous = &g_scheduler.groups[g_selectedGroup];
+    if (prefix_buffer[0] && wcscmp(previous->prefix, prefix_buffer) != 0) {
+        wchar_t* prefixCopy = _wcsdup(prefix_buffer);
+        if (prefixCopy) { free(previous->prefix); previous->prefix = prefixCopy; }
+    }
+    g_selectedGroup = groupIndex;
+    SetWindowTextW(g_hwndPrefixEdit, g_scheduler.groups[groupIndex].prefix);
+}
+
+
+// --- Export ---
+// Formatting lives in export.c; this part takes the snapshot and writes the files.
+
+static int ExportWriteFile(void* context, const char* data, size_t len) {
+    DWORD written = 0;
+    return WriteFile((HANDLE)context, data, (DWORD)len, &written, NULL) && written == len;
+}
+
+// Fills r from t for a pending or running task. The command is stored as "prefix\x1Fsuffix"
+// at *text and expanded by the caller once the locks are released.
+static void SnapshotQueuedTask(TaskRecord* r, const QueuedTask* t, wchar_t** text) {
+    memset(r, 0, sizeof(*r));
+    r->group_index = t->group_index;
+    r->profile_index = t->profile_index;
+    r->enqueued_unix_ms = t->enqueued_unix_ms;
+    r->not_before_unix_ms = t->not_before_unix_ms;
+    r->command = *text;
+    size_t prefixLen = wcslen(t->prefix), suffixLen = wcslen(t->suffix);
+    memcpy(*text, t->prefix, prefixLen * sizeof(wchar_t));
+    (*text)[prefixLen] = L'\x1F';
+    memcpy(*text + prefixLen + 1, t->suffix, (suffixLen + 1) * sizeof(wchar_t));
+    *text += prefixLen + suffixLen + 2;
+}
+
+// Copies the running, queued and scheduled tasks into one allocation (running first) and
+// the history chunk table into another. g_queueLock is held throughout and g_historyLock
+// inside it, the same order GetFromQueue takes them, so every task is in exactly one of
+// pending, running or history. The history records themselves are read later without a lock.
+static TaskRecord* SnapshotTasks(size_t* runningCount, size_t* pendingCount,
+                                 TaskRecord*** chunks, size_t* historyCount) {
+    EnterCriticalSection(&g_queueLock);
+    EnterCriticalSection(&g_historyLock);
+    size_t running = 0, pending = 0, chars = 0;
+    for (int i = 0; i < WORKER_THREAD_COUNT; ++i) {
+        if (!g_runningTasks[i].active) continue;
+        chars += wcslen(g_runningTasks[i].task.prefix) + wcslen(g_runningTasks[i].task.suffix) + 2;
+        running++;
+    }
+    for (int g = 0; g < g_scheduler.group_count; ++g) {
+        const TaskGroup* group = &g_scheduler.groups[g];
+        for (int i = 0; i < group->count; ++i) {
+            const QueuedTask* t = &group->queue[(group->head + i) % MAX_QUEUE_SIZE];
+            chars += wcslen(t->prefix) + wcslen(t->suffix) + 2;
+            pending++;
+        }
+    }
+    for (const DelayedTask* d = g_scheduler.delayed; d; d = d->next) {
+        chars += wcslen(d->task.prefix) + wcslen(d->task.suffix) + 2;
+        pending++;
+    }
+
+    size_t n = running + pending;
+    TaskRecord* records = (TaskRecord*)malloc(n * sizeof(TaskRecord) + chars * sizeof(wchar_t) + 1);
+    if (records) {
+        wchar_t* text = (wchar_t*)(records + n);
+        TaskRecord* r = records;
+        for (int i = 0; i < WORKER_THREAD_COUNT; ++i) {
+            if (!g_runningTasks[i].active) continue;
+            SnapshotQueuedTask(r, &g_runningTasks[i].task, &text);
+            r->started_unix_ms = g_runningTasks[i].started_unix_ms;
+            r++;
+        }
+        for (int g = 0; g < g_scheduler.group_count; ++g) {
+            const TaskGroup* group = &g_scheduler.groups[g];
+            for (int i = 0; i < group->count; ++i) {
+                SnapshotQueuedTask(r++, &group->queue[(group->head + i) % MAX_QUEUE_SIZE], &text);
+            }
+        }
+        for (const DelayedTask* d = g_scheduler.delayed; d; d = d->next) SnapshotQueuedTask(r++, &d->task, &text);
+    }
+
+    *historyCount = g_historyCount;
+    size_t chunkCount = (g_historyCount + HISTORY_CHUNK_RECORDS - 1) / HISTORY_CHUNK_RECORDS;
+    *chunks = (TaskRecord**)malloc((chunkCount ? chunkCount : 1) * sizeof(TaskRecord*));
+    if (*chunks && chunkCount) memcpy(*chunks, g_historyChunks, chunkCount * sizeof(TaskRecord*));
+    LeaveCriticalSection(&g_historyLock);
+    LeaveCriticalSection(&g_queueLock);
+
+    *runningCount = records ? running : 0;
+    *pendingCount = records ? pending : 0;
+    return records;
+}
+
+static void ExportRecord(ExportWriter* w, int format, const TaskRecord* r) {
+    const wchar_t* groupName = g_scheduler.groups[r->group_index].name;
+    const wchar_t* profileName = g_profiles[r->profile_index].name;
+    if (format == 0) ExportCsvRecord(w, r, groupName, profileName);
+    else ExportJsonRecord(w, r, groupName, profileName);
+}
+
+// Writes the run history, then the running, queued and scheduled tasks, to a timestamped
+// .csv and .jsonl pair. Gives up early when the app is closing.
+DWORD WINAPI ExportThread(LPVOID lpParam) {
+    (void)lpParam;
+    LARGE_INTEGER qpcFreq, exportStart, exportEnd;
+    QueryPerformanceFrequency(&qpcFreq);
+    QueryPerformanceCounter(&exportStart);
+
+    size_t runningCount = 0, pendingCount = 0, historyCount = 0;
+    TaskRecord** chunks = NULL;
+    TaskRecord* active = SnapshotTasks(&runningCount, &pendingCount, &chunks, &historyCount);
+    size_t activeCount = runningCount + pendingCount;
+    ULONGLONG snapshotUnixMs = UnixTimeMs();
+
+    // Rebuild the commands from their prefix/suffix pair. The expansion can be longer
+    // than prefix + suffix, so each one gets its own copy.
+    for (size_t i = 0; i < activeCount; ++i) {
+        wchar_t* sep = wcschr(active[i].command, L'\x1F');
+        wchar_t command[2048];
+        *sep = L'\0';
+        ExpandTaskCommand(active[i].command, sep + 1, command, sizeof(command)/sizeof(wchar_t));
+        active[i].command = _wcsdup(command);
+    }
+
+    SYSTEMTIME st;
+    GetLocalTime(&st);
+    wchar_t baseName[64];
+    swprintf(baseName, sizeof(baseName)/sizeof(wchar_t), L"cmdq-export-%04u%02u%02u-%02u%02u%02u",
+             st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond);
+
+    char* buffer = (char*)malloc(EXPORT_BUFFER_SIZE);
+    BOOL ok = (buffer != NULL) && (chunks != NULL) && (active != NULL || activeCount == 0);
+
+    for (int format = 0; format < 2 && ok; ++format) {
+        wchar_t path[MAX_PATH];
+        swprintf(path, MAX_PATH, L"%s.%s", baseName, format == 0 ? L"csv" : L"jsonl");
+        HANDLE file = CreateFileW(path, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) { ok = FALSE; break; }
+
+        ExportWriter w;
+        ExportWriterInit(&w, ExportWriteFile, file, buffer, EXPORT_BUFFER_SIZE, snapshotUnixMs);
+        if (format == 0) ExportCsvHeader(&w);
+        else ExportJsonHeader(&w, historyCount, runningCount, pendingCount);
+        for (size_t i = 0; i < historyCount && !g_appExiting; ++i) {
+            ExportRecord(&w, format, &chunks[i / HISTORY_CHUNK_RECORDS][i % HISTORY_CHUNK_RECORDS]);
+        }
+        for (size_t i = 0; i < activeCount && !g_appExiting; ++i) ExportRecord(&w, format, &active[i]);
+        ok = ExportFlush(&w) && !g_appExiting;
+        CloseHandle(file);
+    }
+    QueryPerformanceCounter(&exportEnd);
+
+    wchar_t msg[256];
+    if (ok) {
+        swprintf(msg, sizeof(msg)/sizeof(wchar_t),
+                 L"Exported %zu finished, %zu running and %zu pending tasks to %s.csv/.jsonl in %.1f ms",
+                 historyCount, runningCount, pendingCount, baseName,
+                 (double)(exportEnd.QuadPart - exportStart.QuadPart) * 1000.0 / (double)qpcFreq.QuadPart);
+    } else {
+        swprintf(msg, sizeof(msg)/sizeof(wchar_t), L"Export to %s failed (Code: %lu)", baseName, GetLastError());
+    }
+    if (!g_appExiting) PostLogChunkToUI_Wide(msg, !ok, FALSE);
+
+    for (size_t i = 0; i < activeCount; ++i) free(active[i].command);
+    free(active);
+    free(chunks);
+    free(buffer);
+    InterlockedExchange(&g_exportRunning, 0);
+    return 0;
+}
+
+void FreeTaskHistory(void) {
+    for (size_t i = 0; i < g_historyCount; ++i) {
+        free(g_historyChunks[i / HISTORY_CHUNK_RECORDS][i % HISTORY_CHUNK_RECORDS].command);
+    }
+    for (size_t c = 0; c < g_historyChunkCapacity; ++c) free(g_historyChunks[c]);
+    free(g_historyChunks);
+    g_historyChunks = NULL;
+    g_historyChunkCapacity = 0;
+    g_historyCount = 0;
+}
+
+
 // --- String Utilities ---
+ULONGLONG UnixTimeMs(void) {
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    ULONGLONG ticks = ((ULONGLONG)ft.dwHighDateTime << 32) | ft.dwLowDateTime; // 100 ns since 1601
+    return (ticks - 116444736000000000ULL) / 10000;
+}
+
 wchar_t* Utf8ToWide(const char* utf8String) {
     if (!utf8String) return NULL;
     int wideLen = MultiByteToWideChar(CP_UTF8, 0, utf8String, -1, NULL, 0);
@@ -740,11 +1561,52 @@ wchar_t* Utf8ToWide(const char* utf8String) {
     return wideString;
 }
 
-void PostLogChunkToUI_Wide(const wchar_t* wide_chunk, BOOL is_stderr_color_hint, BOOL is_progress) {
-    if (!g_hwndMain) { 
-        if (wide_chunk) wprintf(L"%s\n", wide_chunk); 
+// Wakes pipe readers waiting in SubmitTaskLogLine for the UI to catch up.
+void WakeLogWriters(void) {
+    EnterCriticalSection(&g_logRoomLock);
+    WakeAllConditionVariable(&g_logRoom);
+    LeaveCriticalSection(&g_logRoomLock);
+}
+
+// A posted chunk has been drawn (or dropped). Waiting readers are woken only when the
+// count falls below the limit, not for every chunk.
+void LogChunkDone(void) {
+    if (InterlockedDecrement(&g_pendingLogChunks) == MAX_PENDING_LOG_CHUNKS - 1) WakeLogWriters();
+}
+
+// Hands a chunk to the UI thread, which frees it. Until the main window exists (startup
+// messages, command line warnings) chunks are kept and posted by FlushEarlyLogChunks;
+// only the main thread runs then, so the list needs no lock.
+static void PostLogChunk(LogChunk* chunk, BOOL isStdErr) {
+    if (!g_hwndMain) {
+        if (g_earlyLogChunkCount < MAX_EARLY_LOG_CHUNKS) {
+            g_earlyLogChunks[g_earlyLogChunkCount].chunk = chunk;
+            g_earlyLogChunks[g_earlyLogChunkCount].is_stderr = isStdErr;
+            g_earlyLogChunkCount++;
+        } else {
+            free(chunk->text);
+            free(chunk);
+        }
         return;
     }
+    // Count before posting: the UI thread may process (and decrement) before PostMessage returns.
+    InterlockedIncrement(&g_pendingLogChunks);
+    if (!PostMessageW(g_hwndMain, WM_APP_APPEND_LOG_CHUNK, (WPARAM)isStdErr, (LPARAM)chunk)) {
+        LogChunkDone(); // Message queue full, nobody else will free it
+        free(chunk->text);
+        free(chunk);
+    }
+}
+
+// Posts what was logged before the main window existed, in order.
+void FlushEarlyLogChunks(void) {
+    for (int i = 0; i < g_earlyLogChunkCount; ++i) {
+        PostLogChunk(g_earlyLogChunks[i].chunk, g_earlyLogChunks[i].is_stderr);
+    }
+    g_earlyLogChunkCount = 0;
+}
+
+void PostLogChunkToUI_Wide(const wchar_t* wide_chunk, BOOL is_stderr_color_hint, BOOL is_progress) {
     if (!wide_chunk) return;
 
     LogChunk* chunkData = (LogChunk*)malloc(sizeof(LogChunk));
@@ -756,15 +1618,11 @@ void PostLogChunkToUI_Wide(const wchar_t* wide_chunk, BOOL is_stderr_color_hint,
         return;
     }
     chunkData->is_progress_line = is_progress;
-    
-    PostMessageW(g_hwndMain, WM_APP_APPEND_LOG_CHUNK, (WPARAM)is_stderr_color_hint, (LPARAM)chunkData);
+    chunkData->task_id = 0;
+    PostLogChunk(chunkData, is_stderr_color_hint);
 }
 
 void PostLogChunkToUI(const char* utf8_chunk, BOOL is_stderr_color_hint, BOOL is_progress) {
-    if (!g_hwndMain && utf8_chunk) { 
-        printf("%s\n", utf8_chunk); 
-        return;
-    }
     if (!utf8_chunk) return;
 
     LogChunk* chunkData = (LogChunk*)malloc(sizeof(LogChunk));
@@ -778,8 +1636,48 @@ void PostLogChunkToUI(const char* utf8_chunk, BOOL is_stderr_color_hint, BOOL is
     TrimTrailingCr(chunkData->text); 
 
     chunkData->is_progress_line = is_progress;
-    
-    PostMessageW(g_hwndMain, WM_APP_APPEND_LOG_CHUNK, (WPARAM)is_stderr_color_hint, (LPARAM)chunkData);
+    chunkData->task_id = 0;
+    PostLogChunk(chunkData, is_stderr_color_hint);
+}
+
+// Posts one line of a task's output or status, prefixed with the task's tag.
+void PostTaskLogLine_Wide(const TaskLogTag* tag, const wchar_t* line, BOOL isStdErr, BOOL isProgress) {
+    if (!line) return;
+
+    LogChunk* chunkData = (LogChunk*)malloc(sizeof(LogChunk));
+    if (!chunkData) return;
+
+    size_t textLen = wcslen(tag->tag) + 1 + wcslen(line) + 1;
+    chunkData->text = (wchar_t*)malloc(textLen * sizeof(wchar_t));
+    if (!chunkData->text) {
+        free(chunkData);
+        return;
+    }
+    swprintf(chunkData->text, textLen, L"%s %s", tag->tag, line);
+    chunkData->is_progress_line = isProgress;
+    chunkData->task_id = tag->task_id;
+    PostLogChunk(chunkData, isStdErr);
+}
+
+void PostTaskLogLine(const TaskLogTag* tag, const char* utf8_line, BOOL isStdErr, BOOL isProgress) {
+    if (!utf8_line) return;
+    wchar_t* wide = Utf8ToWide(utf8_line);
+    if (!wide) return;
+    TrimTrailingCr(wide);
+    PostTaskLogLine_Wide(tag, wide, isStdErr, isProgress);
+    free(wide);
+}
+
+// Formats value with thousands separators, e.g. 48213 -> "48,213".
+void FormatCount(wchar_t* buffer, size_t bufferLen, ULONGLONG value) {
+    wchar_t digits[32];
+    int n = swprintf(digits, sizeof(digits)/sizeof(wchar_t), L"%llu", value);
+    size_t out = 0;
+    for (int i = 0; i < n && out + 1 < bufferLen; ++i) {
+        if (i > 0 && (n - i) % 3 == 0 && out + 2 < bufferLen) buffer[out++] = L',';
+        buffer[out++] = digits[i];
+    }
+    buffer[out] = L'\0';
 }
 
 void TrimTrailingCr(wchar_t* str) {
@@ -0,0 +1,184 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "scheduler.h"
+
+void SchedulerInit(Scheduler* s, unsigned long long tickMs, unsigned long long nowMs) {
+    memset(s, 0, sizeof(*s));
+    TimerWheelInit(&s->wheel, tickMs, nowMs);
+}
+
+TaskGroup* SchedulerAddGroup(Scheduler* s, int maxRunning, unsigned long long nowMs) {
+    if (s->group_count >= MAX_TASK_GROUPS) return NULL;
+    TaskGroup* group = &s->groups[s->group_count++];
+    memset(group, 0, sizeof(*group));
+    group->max_running = maxRunning;
+    group->quantum = 1;
+    group->start_burst = 1;
+    group->start_tokens = 1.0;
+    group->start_refill_ms = nowMs;
+    TimerEntryInit(&group->rate_timer, NULL);
+    return group;
+}
+
+static void PushTask(TaskGroup* group, const QueuedTask* task) {
+    group->queue[group->tail] = *task;
+    group->tail = (group->tail + 1) % MAX_QUEUE_SIZE;
+    group->count++;
+}
+
+SchedulerAddResult SchedulerAdd(Scheduler* s, const QueuedTask* task, unsigned long long nowMs, SchedulerWake* wake) {
+    TaskGroup* group = &s->groups[task->group_index];
+    *wake = SCHEDULER_WAKE_NONE;
+    if (task->not_before_ms > nowMs) {
+        DelayedTask* delayed = (DelayedTask*)calloc(1, sizeof(DelayedTask));
+        if (!delayed) return SCHEDULER_NO_MEMORY;
+        delayed->task = *task;
+        TimerEntryInit(&delayed->timer, delayed);
+        delayed->next = s->delayed;
+        if (s->delayed) s->delayed->prev = delayed;
+        s->delayed = delayed;
+        group->delayed_count++;
+        TimerWheelSchedule(&s->wheel, &delayed->timer, task->not_before_ms);
+        // Every waiter must recompute its timeout: one woken alone could take the next
+        // task and leave the others sleeping with no deadline while this one comes due.
+        *wake = SCHEDULER_WAKE_ALL;
+        return SCHEDULER_DELAYED;
+    }
+    if (group->count >= MAX_QUEUE_SIZE) return SCHEDULER_QUEUE_FULL;
+    PushTask(group, task);
+    *wake = SCHEDULER_WAKE_ONE;
+    return SCHEDULER_QUEUED;
+}
+
+// Moves a task whose not-before time has come into its group's queue.
+static void ReleaseDelayedTask(Scheduler* s, DelayedTask* delayed, unsigned long long nowMs) {
+    TaskGroup* group = &s->groups[delayed->task.group_index];
+    if (group->count >= MAX_QUEUE_SIZE) {
+        TimerWheelSchedule(&s->wheel, &delayed->timer, nowMs + DELAYED_RETRY_MS);
+        return;
+    }
+    PushTask(group, &delayed->task);
+    group->delayed_count--;
+
+    if (delayed->prev) delayed->prev->next = delayed->next;
+    else s->delayed = delayed->next;
+    if (delayed->next) delayed->next->prev = delayed->prev;
+    free(delayed);
+}
+
+// Fires every timer due by now. Rate-limit timers carry no data: waking up the worker
+// that advanced the wheel is all they are for. Returns how many fired.
+static size_t RunDueTimers(Scheduler* s, unsigned long long nowMs) {
+    TimerEntry* fired = NULL;
+    size_t firedCount = TimerWheelAdvance(&s->wheel, nowMs, &fired);
+    while (fired) {
+        TimerEntry* next = fired->next; // Before ReleaseDelayedTask may reschedule or free it
+        if (fired->data) ReleaseDelayedTask(s, (DelayedTask*)fired->data, nowMs);
+        fired = next;
+    }
+    return firedCount;
+}
+
+// Refills the group's start tokens and, if only a token keeps it from starting a task,
+// arms its rate timer for when the next one arrives.
+static void UpdateStartTokens(Scheduler* s, TaskGroup* group, unsigned long long nowMs) {
+    if (group->starts_per_minute <= 0) return;
+    group->start_tokens += (double)(nowMs - group->start_refill_ms) * group->starts_per_minute / 60000.0;
+    if (group->start_tokens > group->start_burst) group->start_tokens = group->start_burst;
+    group->start_refill_ms = nowMs;
+
+    int waitingForToken = group->count > 0 && group->running < group->max_running && group->start_tokens < 1.0;
+    if (waitingForToken && !TimerEntryArmed(&group->rate_timer)) {
+        unsigned long long waitMs = (unsigned long long)((1.0 - group->start_tokens) * 60000.0 / group->starts_per_minute) + 1;
+        TimerWheelSchedule(&s->wheel, &group->rate_timer, nowMs + waitMs);
+    }
+}
+
+static int GroupCanStart(const TaskGroup* group) {
+    return group->count > 0 && group->running < group->max_running
+        && (group->starts_per_minute <= 0 || group->start_tokens >= 1.0);
+}
+
+// Deficit round-robin over the groups: on its turn a group is credited its quantum and
+// may start that many tasks before the turn passes on, so a group with thousands of
+// queued tasks cannot starve the others. Groups that are idle do not bank credit.
+// Returns the chosen group index or -1 if no group can start a task.
+static int PickNextGroup(Scheduler* s, unsigned long long nowMs) {
+    for (int g = 0; g < s->group_count; ++g) UpdateStartTokens(s, &s->groups[g], nowMs);
+
+    int anyStartable = 0;
+    for (int g = 0; g < s->group_count && !anyStartable; ++g) anyStartable = GroupCanStart(&s->groups[g]);
+    if (!anyStartable) return -1;
+
+    for (;;) {
+        TaskGroup* group = &s->groups[s->drr_cursor];
+        if (GroupCanStart(group)) {
+            if (!s->drr_cursor_credited) {
+                group->deficit += group->quantum;
+                s->drr_cursor_credited = 1;
+            }
+            if (group->deficit >= 1) {
+                group->deficit--;
+                return s->drr_cursor;
+            }
+        } else if (group->count == 0) {
+            group->deficit = 0;
+        }
+        s->drr_cursor = (s->drr_cursor + 1) % s->group_count;
+        s->drr_cursor_credited = 0;
+    }
+}
+
+int SchedulerTake(Scheduler* s, unsigned long long nowMs, QueuedTask* task, unsigned long long* timeoutMs, SchedulerWake* wake) {
+    // More tasks may have become startable than this worker can take.
+    *wake = RunDueTimers(s, nowMs) > 1 ? SCHEDULER_WAKE_ALL : SCHEDULER_WAKE_NONE;
+    int groupIndex = PickNextGroup(s, nowMs);
+    if (groupIndex < 0) {
+        *timeoutMs = TimerWheelNextTimeout(&s->wheel, nowMs);
+        return -1;
+    }
+
+    TaskGroup* group = &s->groups[groupIndex];
+    *task = group->queue[group->head];
+    group->queue[group->head].prefix = NULL;
+    group->queue[group->head].suffix = NULL;
+    group->head = (group->head + 1) % MAX_QUEUE_SIZE;
+    group->count--;
+    group->running++;
+    if (group->starts_per_minute > 0) group->start_tokens -= 1.0;
+
+    // This worker may have been the one sleeping on the wheel's next timeout. Hand that
+    // over, or a delayed task waits for whichever worker next finishes a task.
+    if (s->wheel.count > 0 && *wake == SCHEDULER_WAKE_NONE) *wake = SCHEDULER_WAKE_ONE;
+    *timeoutMs = 0;
+    return groupIndex;
+}
+
+SchedulerWake SchedulerComplete(Scheduler* s, int groupIndex) {
+    s->groups[groupIndex].running--;
+    // The slot may unblock a task of this group that another worker is waiting for.
+    return SCHEDULER_WAKE_ONE;
+}
+
+void SchedulerFree(Scheduler* s) {
+    for (int g = 0; g < s->group_count; ++g) {
+        TaskGroup* group = &s->groups[g];
+        for (int i = 0; i < group->count; ++i) {
+            QueuedTask* task = &group->queue[(group->head + i) % MAX_QUEUE_SIZE];
+            free(task->prefix);
+            free(task->suffix);
+        }
+        group->head = group->tail = group->count = 0;
+        group->delayed_count = 0;
+    }
+
+    while (s->delayed) {
+        DelayedTask* next = s->delayed->next;
+        TimerWheelCancel(&s->wheel, &s->delayed->timer);
+        free(s->delayed->task.prefix);
+        free(s->delayed->task.suffix);
+        free(s->delayed);
+        s->delayed = next;
+    }
+}
@@ -0,0 +1,110 @@
+// Task groups and the choice of what runs next: a FIFO queue per group, deficit round-robin
+// between groups, start-rate limits, and delayed starts parked in a timer wheel. Plain C
+// with no Win32 dependency and no locking or waiting of its own: main.c calls it under
+// g_queueLock and turns the SchedulerWake results into condition variable wake-ups, so
+// scheduler_test.c can check the policy against a mock clock on any platform.
+#ifndef CMDQ_SCHEDULER_H
+#define CMDQ_SCHEDULER_H
+
+#include <wchar.h>
+
+#include "timerwheel.h"
+
+#define MAX_QUEUE_SIZE   100  // Per task group
+#define MAX_TASK_GROUPS  8
+#define DELAYED_RETRY_MS 1000 // When a scheduled task is due but its group's queue is full
+
+// Times are milliseconds on the caller's monotonic clock (GetTickCount64 in the app),
+// except the *_unix_ms fields which the scheduler only carries along.
+typedef struct {
+    wchar_t* prefix;
+    wchar_t* suffix;
+    int profile_index; // Index into the app's launch profiles, captured at click time like the prefix
+    int group_index;   // Index into Scheduler.groups
+    unsigned long long not_before_ms; // Time before which the task may not start, 0 for none
+    unsigned long long enqueued_unix_ms;
+    unsigned long long not_before_unix_ms; // not_before_ms as wall-clock time, for the export
+} QueuedTask;
+
+// A task waiting for its not-before time, parked in the wheel instead of a group queue.
+typedef struct DelayedTask {
+    TimerEntry timer;          // data points back at this DelayedTask
+    QueuedTask task;
+    struct DelayedTask* prev;  // Scheduler.delayed list, so they can be listed and freed
+    struct DelayedTask* next;
+} DelayedTask;
+
+// Totals over a group's finished tasks.
+typedef struct {
+    unsigned long long tasks_done;
+    unsigned long long tasks_failed;   // Non-zero exit code or failed to start
+    unsigned long long tasks_started;  // Process created; the run time average is over these only
+    unsigned long long bytes_out;      // stdout + stderr bytes
+    double run_seconds_total;
+} TaskGroupStats;
+
+// A named stream of tasks with its own prefix, concurrency cap and statistics.
+typedef struct {
+    wchar_t name[32];
+    wchar_t* prefix;          // Prefix or template for new tasks, owned by the app
+    int max_running;
+    int quantum;              // Deficit round-robin weight: tasks started per turn
+    int deficit;
+    QueuedTask queue[MAX_QUEUE_SIZE];
+    int head, tail, count;
+    int running;
+    int delayed_count;        // Tasks waiting for their not-before time
+    // Start-rate limit: a token bucket refilled at starts_per_minute, holding up to start_burst
+    int starts_per_minute;    // 0 for unlimited
+    int start_burst;
+    double start_tokens;
+    unsigned long long start_refill_ms;
+    TimerEntry rate_timer;    // Armed while tasks wait only for a token
+    TaskGroupStats stats;
+} TaskGroup;
+
+typedef struct {
+    TaskGroup groups[MAX_TASK_GROUPS];
+    int group_count;
+    int drr_cursor;           // Group whose turn it is
+    int drr_cursor_credited;  // Whether that group already got its quantum this turn
+    TimerWheel wheel;         // Not-before times and rate-limit refills, advanced by waiting workers
+    DelayedTask* delayed;
+} Scheduler;
+
+// Which of the workers waiting to take a task the caller should wake after a call.
+typedef enum {
+    SCHEDULER_WAKE_NONE,
+    SCHEDULER_WAKE_ONE,
+    SCHEDULER_WAKE_ALL
+} SchedulerWake;
+
+typedef enum {
+    SCHEDULER_QUEUED,
+    SCHEDULER_DELAYED,        // Parked until task->not_before_ms
+    SCHEDULER_QUEUE_FULL,
+    SCHEDULER_NO_MEMORY
+} SchedulerAddResult;
+
+void SchedulerInit(Scheduler* s, unsigned long long tickMs, unsigned long long nowMs);
+
+// Appends a group with a quantum of 1 and no start-rate limit, or returns NULL when all
+// MAX_TASK_GROUPS are in use. The caller fills in name and prefix.
+TaskGroup* SchedulerAddGroup(Scheduler* s, int maxRunning, unsigned long long nowMs);
+
+// Queues task in its group, or parks it until its not-before time. On QUEUED and DELAYED
+// the scheduler owns the task's strings; otherwise they stay with the caller.
+SchedulerAddResult SchedulerAdd(Scheduler* s, const QueuedTask* task, unsigned long long nowMs, SchedulerWake* wake);
+
+// Fires the timers due by nowMs, then picks a group that may start a task, dequeues the
+// task into *task and counts it as running. Returns the group index, or -1 with *timeoutMs
+// set to how long the caller may wait before calling again (TIMER_WHEEL_IDLE: until woken).
+int SchedulerTake(Scheduler* s, unsigned long long nowMs, QueuedTask* task, unsigned long long* timeoutMs, SchedulerWake* wake);
+
+// A task of groupIndex finished, which may let another of its tasks start.
+SchedulerWake SchedulerComplete(Scheduler* s, int groupIndex);
+
+// Frees every queued and delayed task and empties the groups (but not their prefixes).
+void SchedulerFree(Scheduler* s);
+
+#endif // CMDQ_SCHEDULER_H
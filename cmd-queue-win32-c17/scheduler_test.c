@@ -0,0 +1,293 @@
+// Host-built checks for scheduler.c: the DRR pick, start-rate limits and delayed starts,
+// and the worker wake-up policy, simulated with a mock clock (make test).
+#include <stdio.h>
+#include <string.h>
+
+#include "scheduler.h"
+
+#define TICK_MS      100
+#define SIM_WORKERS  4
+#define SIM_TASKS    2048
+#define SIM_NEVER    (~0ULL) // A worker waiting with no timeout
+
+static int g_checks = 0;
+static int g_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    g_checks++; \
+    if (!(cond)) { \
+        g_failures++; \
+        fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, #cond); \
+        fprintf(stderr, __VA_ARGS__); \
+        fputc('\n', stderr); \
+    } \
+} while (0)
+
+// Deterministic xorshift, so a failure reproduces.
+static unsigned long long g_rng = 0x2545F4914F6CDD1DULL;
+static unsigned long long Random(unsigned long long bound) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return bound ? g_rng % bound : 0;
+}
+
+// Tasks are told apart by enqueued_unix_ms, which the scheduler only carries along.
+static QueuedTask MakeTask(int id, int groupIndex, unsigned long long notBeforeMs) {
+    QueuedTask task;
+    memset(&task, 0, sizeof(task));
+    task.group_index = groupIndex;
+    task.not_before_ms = notBeforeMs;
+    task.enqueued_unix_ms = (unsigned long long)id;
+    return task;
+}
+
+static void Add(Scheduler* s, int id, int groupIndex, unsigned long long notBeforeMs, unsigned long long nowMs) {
+    QueuedTask task = MakeTask(id, groupIndex, notBeforeMs);
+    SchedulerWake wake;
+    SchedulerAddResult added = SchedulerAdd(s, &task, nowMs, &wake);
+    CHECK(added == (notBeforeMs > nowMs ? SCHEDULER_DELAYED : SCHEDULER_QUEUED), "task %d: result %d", id, (int)added);
+}
+
+// Returns the id of the task taken, or -1.
+static int Take(Scheduler* s, unsigned long long nowMs, unsigned long long* timeoutMs) {
+    QueuedTask task;
+    SchedulerWake wake;
+    unsigned long long timeout;
+    int groupIndex = SchedulerTake(s, nowMs, &task, &timeout, &wake);
+    if (timeoutMs) *timeoutMs = timeout;
+    return groupIndex < 0 ? -1 : (int)task.enqueued_unix_ms;
+}
+
+static void TestRoundRobinAndCaps(void) {
+    Scheduler s;
+    SchedulerInit(&s, TICK_MS, 0);
+    TaskGroup* a = SchedulerAddGroup(&s, 4, 0);
+    TaskGroup* b = SchedulerAddGroup(&s, 1, 0);
+    a->quantum = 2;
+    for (int i = 0; i < 6; ++i) Add(&s, 100 + i, 0, 0, 0);
+    for (int i = 0; i < 3; ++i) Add(&s, 200 + i, 1, 0, 0);
+
+    // a gets two starts per turn, b one, and b never more than one at a time.
+    const int expected[] = { 100, 101, 200, 102, 103, 104, 105 };
+    for (int i = 0; i < 7; ++i) {
+        int id = Take(&s, 0, NULL);
+        CHECK(id == expected[i], "take %d: task %d, expected %d", i, id, expected[i]);
+        if (id >= 100 && id < 200 && a->running == a->max_running) SchedulerComplete(&s, 0);
+    }
+    unsigned long long timeout;
+    CHECK(b->running == 1 && b->count == 2, "b: %d running, %d queued", b->running, b->count);
+    CHECK(Take(&s, 0, &timeout) == -1, "b started past its cap");
+    CHECK(timeout == TIMER_WHEEL_IDLE, "timeout %llu with nothing scheduled", timeout);
+    SchedulerComplete(&s, 1);
+    CHECK(Take(&s, 0, NULL) == 201, "b's next task did not start after a completion");
+    SchedulerFree(&s);
+}
+
+static void TestStartRate(void) {
+    Scheduler s;
+    SchedulerInit(&s, TICK_MS, 0);
+    TaskGroup* group = SchedulerAddGroup(&s, 8, 0);
+    group->starts_per_minute = 60;
+    for (int i = 0; i < 3; ++i) Add(&s, i, 0, 0, 0);
+
+    unsigned long long timeout;
+    CHECK(Take(&s, 0, NULL) == 0, "burst token not used");
+    CHECK(Take(&s, 0, &timeout) == -1, "started without a token");
+    CHECK(timeout != TIMER_WHEEL_IDLE && timeout <= 1000 + TICK_MS, "timeout %llu for a 1 s refill", timeout);
+    CHECK(Take(&s, 900, NULL) == -1, "started before the token arrived");
+    CHECK(Take(&s, 1100, NULL) == 1, "token did not arrive");
+    SchedulerFree(&s);
+}
+
+static void TestDelayedStart(void) {
+    Scheduler s;
+    SchedulerInit(&s, TICK_MS, 0);
+    SchedulerAddGroup(&s, 1, 0);
+    Add(&s, 1, 0, 2500, 0);
+    CHECK(s.delayed && s.groups[0].delayed_count == 1, "delayed task not parked");
+
+    unsigned long long timeout;
+    CHECK(Take(&s, 0, &timeout) == -1, "delayed task started early");
+    CHECK(timeout > 0 && timeout <= 2500, "timeout %llu for a task due at 2500", timeout);
+    CHECK(Take(&s, 2400, NULL) == -1, "delayed task started early");
+    CHECK(Take(&s, 2500, NULL) == 1, "delayed task did not start when due");
+    CHECK(!s.delayed && s.groups[0].delayed_count == 0, "delayed task still listed");
+
+    // Due while the group's queue is full: retried DELAYED_RETRY_MS later.
+    for (int i = 0; i < MAX_QUEUE_SIZE; ++i) Add(&s, 100 + i, 0, 0, 2500);
+    Add(&s, 2, 0, 3000, 2500);
+    CHECK(Take(&s, 3000, NULL) == -1, "group past its cap");
+    CHECK(s.delayed != NULL, "delayed task dropped with the queue full");
+    SchedulerComplete(&s, 0);
+    CHECK(Take(&s, 3000, NULL) == 100, "queued task lost");
+    CHECK(Take(&s, 3000 + DELAYED_RETRY_MS, NULL) == -1, "group past its cap");
+    CHECK(s.delayed == NULL, "delayed task not queued on retry");
+    SchedulerFree(&s);
+}
+
+// --- Worker simulation ---
+// Models the workers in GetFromQueue: each either runs a task until it finishes, or waits
+// until woken or until the timeout SchedulerTake gave it. WakeConditionVariable may wake any
+// waiter; the simulation always wakes the one with the earliest deadline, i.e. the worker
+// already watching the wheel, which is the choice that can leave a delayed task unwatched.
+typedef struct {
+    int running;
+    int group_index;
+    unsigned long long wake_ms; // Running: when its task finishes. Waiting: deadline or SIM_NEVER
+} SimWorker;
+
+static Scheduler g_sim;
+static SimWorker g_workers[SIM_WORKERS];
+static unsigned long long g_simNowMs;
+static unsigned long long g_runMs[SIM_TASKS];
+static unsigned long long g_dueMs[SIM_TASKS];
+static unsigned long long g_startedMs[SIM_TASKS];
+static int g_startedCount;
+
+static void SimWake(SchedulerWake wake) {
+    if (wake == SCHEDULER_WAKE_NONE) return;
+    SimWorker* chosen = NULL;
+    for (int i = 0; i < SIM_WORKERS; ++i) {
+        SimWorker* w = &g_workers[i];
+        if (w->running) continue;
+        if (wake == SCHEDULER_WAKE_ALL) w->wake_ms = g_simNowMs;
+        else if (!chosen || w->wake_ms < chosen->wake_ms) chosen = w;
+    }
+    if (chosen) chosen->wake_ms = g_simNowMs;
+}
+
+static void SimRunWorker(SimWorker* w) {
+    if (w->running) {
+        w->running = 0;
+        SimWake(SchedulerComplete(&g_sim, w->group_index));
+    }
+    QueuedTask task;
+    SchedulerWake wake;
+    unsigned long long timeout;
+    int groupIndex = SchedulerTake(&g_sim, g_simNowMs, &task, &timeout, &wake);
+    if (groupIndex >= 0) {
+        int id = (int)task.enqueued_unix_ms;
+        g_startedMs[id] = g_simNowMs;
+        g_startedCount++;
+        w->running = 1;
+        w->group_index = groupIndex;
+        w->wake_ms = g_simNowMs + g_runMs[id];
+    } else {
+        w->wake_ms = timeout == TIMER_WHEEL_IDLE ? SIM_NEVER : g_simNowMs + (timeout ? timeout : 1);
+    }
+    SimWake(wake);
+}
+
+// Runs every worker due at the current time until all are running or waiting again.
+static void SimSettle(void) {
+    for (int rounds = 0; rounds < 10000; ++rounds) {
+        SimWorker* due = NULL;
+        for (int i = 0; i < SIM_WORKERS && !due; ++i) {
+            if (g_workers[i].wake_ms <= g_simNowMs) due = &g_workers[i];
+        }
+        if (!due) break;
+        SimRunWorker(due);
+    }
+
+    // While anything is on the wheel and a worker waits, one of the waiters must have a
+    // deadline; otherwise the wheel only advances when some task happens to finish.
+    int waiting = 0, watching = 0;
+    for (int i = 0; i < SIM_WORKERS; ++i) {
+        if (g_workers[i].running) continue;
+        waiting++;
+        if (g_workers[i].wake_ms != SIM_NEVER) watching++;
+    }
+    CHECK(g_sim.wheel.count == 0 || waiting == 0 || watching > 0,
+          "at %llu ms %zu timers pending and %d idle workers all wait without a timeout",
+          g_simNowMs, g_sim.wheel.count, waiting);
+}
+
+static void SimAdvanceTo(unsigned long long nowMs) {
+    for (;;) {
+        unsigned long long next = nowMs;
+        for (int i = 0; i < SIM_WORKERS; ++i) {
+            if (g_workers[i].wake_ms < next) next = g_workers[i].wake_ms;
+        }
+        if (next > g_simNowMs) g_simNowMs = next;
+        SimSettle();
+        if (next >= nowMs) break;
+    }
+}
+
+static void SimReset(int workerCount) {
+    SchedulerInit(&g_sim, TICK_MS, 0);
+    g_simNowMs = 0;
+    g_startedCount = 0;
+    for (int i = 0; i < SIM_WORKERS; ++i) {
+        // Workers beyond workerCount stay busy forever.
+        g_workers[i] = (SimWorker){ i >= workerCount, -1, i >= workerCount ? SIM_NEVER : 0 };
+    }
+    memset(g_startedMs, 0xFF, sizeof(g_startedMs));
+}
+
+static void SimAdd(int id, int groupIndex, unsigned long long delayMs, unsigned long long runMs) {
+    QueuedTask task = MakeTask(id, groupIndex, delayMs ? g_simNowMs + delayMs : 0);
+    g_runMs[id] = runMs;
+    g_dueMs[id] = g_simNowMs + delayMs;
+    SchedulerWake wake;
+    SchedulerAddResult added = SchedulerAdd(&g_sim, &task, g_simNowMs, &wake);
+    CHECK(added == SCHEDULER_QUEUED || added == SCHEDULER_DELAYED, "task %d: result %d", id, (int)added);
+    SimWake(wake);
+    SimSettle();
+}
+
+// Two idle workers. A delayed task is added, then a long immediate one. The waiter that
+// woke for the delayed task and now sleeps until it is due takes the long task; unless it
+// hands the wheel to the other waiter, the delayed task starts only when the long one ends.
+static void TestDelayedTaskNotStranded(void) {
+    SimReset(2);
+    SchedulerAddGroup(&g_sim, 2, 0);
+    SimSettle();
+    SimAdd(0, 0, 1000, 10);
+    SimAdvanceTo(10);
+    SimAdd(1, 0, 0, 100000);
+    SimAdvanceTo(5000);
+    CHECK(g_startedMs[1] == 10, "long task started at %llu", g_startedMs[1]);
+    CHECK(g_startedMs[0] == 1000, "task due at 1000 ms started at %llu", g_startedMs[0]);
+    SchedulerFree(&g_sim);
+}
+
+// Random mix of immediate and delayed tasks over several groups, one of them rate-limited.
+// A delayed task may start late only if no worker was free when it came due.
+static void TestRandomWorkload(void) {
+    SimReset(SIM_WORKERS);
+    SchedulerAddGroup(&g_sim, 2, 0);
+    TaskGroup* limited = SchedulerAddGroup(&g_sim, 2, 0);
+    limited->starts_per_minute = 120;
+    SchedulerAddGroup(&g_sim, 4, 0)->quantum = 2;
+    SimSettle();
+
+    int added = 0;
+    while (added < 600) {
+        SimAdvanceTo(g_simNowMs + Random(400));
+        int queued = 0;
+        for (int g = 0; g < g_sim.group_count; ++g) queued += g_sim.groups[g].count;
+        if (queued > MAX_QUEUE_SIZE / 2) continue;
+        int delayed = Random(3) == 0;
+        SimAdd(added, (int)Random(3), delayed ? 1 + Random(8000) : 0, 1 + Random(2500));
+        added++;
+    }
+    SimAdvanceTo(g_simNowMs + 10000000);
+
+    CHECK(g_startedCount == added, "%d of %d tasks started", g_startedCount, added);
+    for (int id = 0; id < added; ++id) {
+        CHECK(g_startedMs[id] >= g_dueMs[id], "task %d due at %llu started at %llu", id, g_dueMs[id], g_startedMs[id]);
+    }
+    SchedulerFree(&g_sim);
+}
+
+int main(void) {
+    TestRoundRobinAndCaps();
+    TestStartRate();
+    TestDelayedStart();
+    TestDelayedTaskNotStranded();
+    TestRandomWorkload();
+    printf("scheduler_test: %d checks, %d failed\n", g_checks, g_failures);
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+// Spawn-rate benchmark: how many trivial children per second each launch path starts.
+//
+//   spawn_bench.exe [count] [inheritable handles]
+//
+// Launches count copies of this program in --child mode (exits at once) one after another
+// through LaunchChildProcess, then through the old path: CreatePipe and SetHandleInformation
+// twice, and CreateProcessW inheriting every inheritable handle with our own stdin. The
+// extra inheritable handles (events, default 256) stand in for whatever else the app has
+// open; the old path duplicates all of them into every child.
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+#include "launcher.h"
+
+#define DEFAULT_COUNT    500
+#define DEFAULT_HANDLES  256
+#define MAX_COUNT        100000
+
+typedef BOOL (*LaunchFn)(void* context, wchar_t* cmdLine, HANDLE* outRead, HANDLE* errRead, PROCESS_INFORMATION* pi);
+
+static BOOL LaunchExplicitList(void* context, wchar_t* cmdLine, HANDLE* outRead, HANDLE* errRead, PROCESS_INFORMATION* pi) {
+    return LaunchChildProcess((ProcessLauncher*)context, cmdLine, NULL, NULL, outRead, errRead, pi);
+}
+
+// The launch sequence the worker used before LaunchChildProcess.
+static BOOL LaunchInheritAll(void* context, wchar_t* cmdLine, HANDLE* outRead, HANDLE* errRead, PROCESS_INFORMATION* pi) {
+    (void)context;
+    SECURITY_ATTRIBUTES sa = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+    HANDLE hOutRd, hOutWr, hErrRd, hErrWr;
+    if (!CreatePipe(&hOutRd, &hOutWr, &sa, 0)) return FALSE;
+    if (!CreatePipe(&hErrRd, &hErrWr, &sa, 0)) {
+        CloseHandle(hOutRd); CloseHandle(hOutWr);
+        return FALSE;
+    }
+    SetHandleInformation(hOutRd, HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(hErrRd, HANDLE_FLAG_INHERIT, 0);
+
+    STARTUPINFOW si = {0};
+    si.cb = sizeof(si);
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    si.hStdOutput = hOutWr;
+    si.hStdError = hErrWr;
+    BOOL success = CreateProcessW(NULL, cmdLine, NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, NULL, &si, pi);
+    CloseHandle(hOutWr);
+    CloseHandle(hErrWr);
+    if (success) {
+        *outRead = hOutRd;
+        *errRead = hErrRd;
+    } else {
+        CloseHandle(hOutRd);
+        CloseHandle(hErrRd);
+    }
+    return success;
+}
+
+static int CompareDouble(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Spawns count children through launch, waiting for each; returns spawns per second.
+static double Run(const wchar_t* name, LaunchFn launch, void* context, const wchar_t* selfPath, int count) {
+    static double launchMs[MAX_COUNT];
+    LARGE_INTEGER freq, start, end, t0, t1;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    int failed = 0;
+    for (int i = 0; i < count; ++i) {
+        wchar_t cmdLine[MAX_PATH + 16];
+        swprintf(cmdLine, sizeof(cmdLine)/sizeof(wchar_t), L"\"%s\" --child", selfPath);
+        HANDLE outRead, errRead;
+        PROCESS_INFORMATION pi = {0};
+        QueryPerformanceCounter(&t0);
+        BOOL ok = launch(context, cmdLine, &outRead, &errRead, &pi);
+        QueryPerformanceCounter(&t1);
+        launchMs[i] = (double)(t1.QuadPart - t0.QuadPart) * 1000.0 / (double)freq.QuadPart;
+        if (!ok) {
+            failed++;
+            continue;
+        }
+        WaitForSingleObject(pi.hProcess, INFINITE);
+        CloseHandle(pi.hProcess);
+        CloseHandle(pi.hThread);
+        CloseHandle(outRead);
+        CloseHandle(errRead);
+    }
+    QueryPerformanceCounter(&end);
+
+    double seconds = (double)(end.QuadPart - start.QuadPart) / (double)freq.QuadPart;
+    double rate = (double)(count - failed) / seconds;
+    qsort(launchMs, count, sizeof(double), CompareDouble);
+    wprintf(L"%-14s %6d spawns in %7.2f s: %7.1f spawns/s, launch p50 %.3f ms, p99 %.3f ms, %d failed\n",
+            name, count, seconds, rate, launchMs[count / 2], launchMs[(count - 1) * 99 / 100], failed);
+    return failed ? 0.0 : rate;
+}
+
+int wmain(int argc, wchar_t** argv) {
+    if (argc >= 2 && wcscmp(argv[1], L"--child") == 0) return 0;
+
+    int count = argc >= 2 ? _wtoi(argv[1]) : DEFAULT_COUNT;
+    int handleCount = argc >= 3 ? _wtoi(argv[2]) : DEFAULT_HANDLES;
+    if (count <= 0 || count > MAX_COUNT) count = DEFAULT_COUNT;
+    if (handleCount < 0) handleCount = DEFAULT_HANDLES;
+
+    wchar_t selfPath[MAX_PATH];
+    GetModuleFileNameW(NULL, selfPath, MAX_PATH);
+
+    SECURITY_ATTRIBUTES sa = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+    HANDLE* extra = (HANDLE*)calloc(handleCount ? handleCount : 1, sizeof(HANDLE));
+    if (!extra) return 1;
+    for (int i = 0; i < handleCount; ++i) extra[i] = CreateEventW(&sa, TRUE, FALSE, NULL);
+
+    HANDLE nulInput = CreateFileW(L"NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, &sa, OPEN_EXISTING, 0, NULL);
+    if (nulInput == INVALID_HANDLE_VALUE) nulInput = NULL;
+    ProcessLauncher launcher;
+    if (!InitProcessLauncher(&launcher, nulInput)) {
+        fwprintf(stderr, L"FAIL: cannot allocate the attribute list\n");
+        return 1;
+    }
+
+    wprintf(L"%d inheritable handles open besides the pipes\n", handleCount);
+    Run(L"warm-up", LaunchExplicitList, &launcher, selfPath, count < 20 ? count : 20);
+    double explicitRate = Run(L"handle list", LaunchExplicitList, &launcher, selfPath, count);
+    double inheritRate = Run(L"inherit-all", LaunchInheritAll, NULL, selfPath, count);
+    if (explicitRate > 0.0 && inheritRate > 0.0) {
+        wprintf(L"handle list: %.2fx the spawn rate of inherit-all\n", explicitRate / inheritRate);
+    }
+
+    FreeProcessLauncher(&launcher);
+    if (nulInput) CloseHandle(nulInput);
+    for (int i = 0; i < handleCount; ++i) if (extra[i]) CloseHandle(extra[i]);
+    free(extra);
+    return (explicitRate > 0.0 && inheritRate > 0.0) ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "tasklog.h"
+
+// --- Line Splitting ---
+void LineSplitterInit(LineSplitter* splitter) {
+    splitter->len = 0;
+    splitter->buffer[0] = '\0';
+}
+
+void LineSplitterFeed(LineSplitter* splitter, const char* data, size_t len, LineSink sink, void* ctx) {
+    char* buffer = splitter->buffer;
+    if (splitter->len + len < sizeof(splitter->buffer)) {
+        memcpy(buffer + splitter->len, data, len);
+        splitter->len += len;
+    } else {
+        // A line longer than the buffer: pass on what we have as its own line, so it is
+        // budgeted like any other, and start over with the new data.
+        buffer[splitter->len] = '\0';
+        sink(ctx, buffer, LINE_PART);
+        if (len >= sizeof(splitter->buffer)) len = sizeof(splitter->buffer) - 1;
+        memcpy(buffer, data, len);
+        splitter->len = len;
+    }
+    buffer[splitter->len] = '\0';
+
+    size_t start = 0;
+    for (size_t i = 0; i < splitter->len; ++i) {
+        char c = buffer[i];
+        if (c != '\r' && c != '\n') continue;
+        int crlf = (c == '\r' && i + 1 < splitter->len && buffer[i + 1] == '\n');
+        int progress = (c == '\r' && i + 1 < splitter->len && !crlf);
+        buffer[i] = '\0';
+        sink(ctx, buffer + start, progress ? LINE_PROGRESS : 0);
+        if (crlf) ++i;
+        start = i + 1;
+    }
+
+    splitter->len -= start;
+    memmove(buffer, buffer + start, splitter->len);
+    buffer[splitter->len] = '\0';
+}
+
+void LineSplitterFinish(LineSplitter* splitter, LineSink sink, void* ctx) {
+    if (splitter->len == 0) return;
+    splitter->buffer[splitter->len] = '\0';
+    sink(ctx, splitter->buffer, 0);
+    splitter->len = 0;
+}
+
+// --- Log Budget ---
+void TaskLogBudgetInit(TaskLogBudget* budget, unsigned long long nowMs) {
+    memset(budget, 0, sizeof(*budget));
+    budget->tokens = LOG_RATE_BURST_LINES;
+    budget->last_refill_ms = nowMs;
+    budget->last_report_ms = nowMs;
+}
+
+void TaskLogBudgetFree(TaskLogBudget* budget) {
+    free(budget->pending_progress);
+    budget->pending_progress = NULL;
+}
+
+TaskLogDecision TaskLogBudgetSubmit(TaskLogBudget* budget, const char* line, int isProgress, unsigned long long nowMs) {
+    TaskLogDecision decision = {0};
+    size_t len = strlen(line);
+
+    budget->tokens += (double)(nowMs - budget->last_refill_ms) * LOG_RATE_LINES_PER_SEC / 1000.0;
+    if (budget->tokens > LOG_RATE_BURST_LINES) budget->tokens = LOG_RATE_BURST_LINES;
+    budget->last_refill_ms = nowMs;
+    budget->lines_total++;
+    budget->bytes_total += len;
+
+    int withinBytes = budget->bytes_shown + len <= LOG_TASK_BYTE_BUDGET;
+    decision.show = withinBytes && budget->tokens >= 1.0;
+    if (decision.show) {
+        budget->tokens -= 1.0;
+        budget->bytes_shown += len;
+        free(budget->pending_progress); // Superseded by whatever is shown now
+        budget->pending_progress = NULL;
+    } else {
+        budget->suppressed_lines++;
+        budget->suppressed_lines_total++;
+        budget->suppressed_bytes += len;
+        if (isProgress && withinBytes) {
+            char* copy = (char*)malloc(len + 1);
+            if (copy) {
+                memcpy(copy, line, len + 1);
+                free(budget->pending_progress);
+                budget->pending_progress = copy;
+            }
+        }
+        if (!withinBytes && !budget->budget_exhausted_reported) {
+            budget->budget_exhausted_reported = 1;
+            decision.budget_exhausted = 1;
+        }
+    }
+    decision.report_due = budget->suppressed_lines > 0 && nowMs - budget->last_report_ms >= LOG_SUPPRESS_REPORT_MS;
+    return decision;
+}
+
+int TaskLogBudgetTakeReport(TaskLogBudget* budget, unsigned long long nowMs,
+                            unsigned long long* lines, unsigned long long* bytes) {
+    if (budget->suppressed_lines == 0) return 0;
+    *lines = budget->suppressed_lines;
+    *bytes = budget->suppressed_bytes;
+    budget->suppressed_lines = 0;
+    budget->suppressed_bytes = 0;
+    budget->last_report_ms = nowMs;
+    return 1;
+}
+
+char* TaskLogBudgetTakePendingProgress(TaskLogBudget* budget) {
+    char* line = budget->pending_progress;
+    budget->pending_progress = NULL;
+    return line;
+}
@@ -0,0 +1,76 @@
+// A task's log path up to the UI: cutting pipe output into lines, and the per-task rate
+// and byte budget that decides which lines are shown. Plain C with no Win32 dependency
+// and no locking (a task's two pipe readers share one TaskLogBudget under the caller's
+// lock); time is passed in, so engine_bench.c can drive the same code on any platform.
+#ifndef CMDQ_TASKLOG_H
+#define CMDQ_TASKLOG_H
+
+#include <stddef.h>
+
+#define PIPE_BUFFER_SIZE 4096 // Bytes per pipe read
+
+// Output beyond these limits is counted and summarized, not displayed
+#define LOG_RATE_LINES_PER_SEC 200          // Sustained lines per second a task may send to the log
+#define LOG_RATE_BURST_LINES   400          // Lines a task may send at once before the rate applies
+#define LOG_TASK_BYTE_BUDGET   (4u << 20)   // Bytes per task shown in the log, the rest is only counted
+#define LOG_SUPPRESS_REPORT_MS 1000         // Minimum interval between "lines suppressed" summaries
+
+// --- Line Splitting ---
+#define LINE_PROGRESS 1 // Ended by a lone \r: replaces the task's previous progress line
+#define LINE_PART     2 // Part of a line longer than the buffer, passed on as it is
+
+typedef void (*LineSink)(void* ctx, const char* line, int flags);
+
+// Holds the unfinished line between reads of one pipe.
+typedef struct {
+    char buffer[PIPE_BUFFER_SIZE * 2];
+    size_t len;
+} LineSplitter;
+
+void LineSplitterInit(LineSplitter* splitter);
+
+// Passes every line completed by data to sink, without its line break. A \r right at the
+// end of data ends a line that is not treated as progress.
+void LineSplitterFeed(LineSplitter* splitter, const char* data, size_t len, LineSink sink, void* ctx);
+
+// Passes on what is left once the pipe is closed.
+void LineSplitterFinish(LineSplitter* splitter, LineSink sink, void* ctx);
+
+// --- Log Budget ---
+typedef struct {
+    double tokens;                 // Token bucket for lines, refilled at LOG_RATE_LINES_PER_SEC
+    unsigned long long last_refill_ms;
+    unsigned long long last_report_ms;
+    unsigned long long lines_total, bytes_total;
+    unsigned long long bytes_shown;
+    unsigned long long suppressed_lines, suppressed_bytes; // Since the last summary
+    unsigned long long suppressed_lines_total;
+    int budget_exhausted_reported;
+    int long_line_reported;
+    char* pending_progress;        // Latest suppressed progress line, shown once tokens allow
+} TaskLogBudget;
+
+// What to do with a submitted line.
+typedef struct {
+    int show;              // Post the line
+    int report_due;        // Post a "lines suppressed" summary first (TaskLogBudgetTakeReport)
+    int budget_exhausted;  // The byte budget was just reached: say so, once per task
+} TaskLogDecision;
+
+void TaskLogBudgetInit(TaskLogBudget* budget, unsigned long long nowMs);
+void TaskLogBudgetFree(TaskLogBudget* budget);
+
+// Lines within the task's rate and byte budget are shown; the rest are only counted and
+// reported as a summary at most once per LOG_SUPPRESS_REPORT_MS, so a firehose child
+// costs the UI one message per second instead of one per line.
+TaskLogDecision TaskLogBudgetSubmit(TaskLogBudget* budget, const char* line, int isProgress, unsigned long long nowMs);
+
+// Returns 0 if nothing was suppressed since the last summary; otherwise hands out the
+// counts for one and starts counting afresh.
+int TaskLogBudgetTakeReport(TaskLogBudget* budget, unsigned long long nowMs,
+                            unsigned long long* lines, unsigned long long* bytes);
+
+// The progress line still held back, or NULL. The caller frees it.
+char* TaskLogBudgetTakePendingProgress(TaskLogBudget* budget);
+
+#endif // CMDQ_TASKLOG_H
@@ -0,0 +1,137 @@
+// Host-built checks for tasklog.c: line splitting and the per-task log budget (make test).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tasklog.h"
+
+static int g_checks = 0;
+static int g_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    g_checks++; \
+    if (!(cond)) { \
+        g_failures++; \
+        fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, #cond); \
+        fprintf(stderr, __VA_ARGS__); \
+        fputc('\n', stderr); \
+    } \
+} while (0)
+
+// Collects what a LineSplitter passes on, as "flags:text" entries.
+typedef struct {
+    char lines[16][64];
+    size_t lengths[16];
+    int count;
+} Collected;
+
+static void Collect(void* ctx, const char* line, int flags) {
+    Collected* c = (Collected*)ctx;
+    if (c->count >= 16) return;
+    c->lengths[c->count] = strlen(line);
+    snprintf(c->lines[c->count], sizeof(c->lines[0]), "%d:%.40s", flags, line);
+    c->count++;
+}
+
+static void Feed(LineSplitter* splitter, Collected* c, const char* text) {
+    LineSplitterFeed(splitter, text, strlen(text), Collect, c);
+}
+
+static void TestLineEndings(void) {
+    LineSplitter splitter;
+    Collected c = {0};
+    LineSplitterInit(&splitter);
+    Feed(&splitter, &c, "one\ntwo\r\nthree\r50%\r100%\n");
+    CHECK(c.count == 5, "%d lines", c.count);
+    const char* expected[] = { "0:one", "0:two", "1:three", "1:50%", "0:100%" };
+    for (int i = 0; i < 5 && i < c.count; ++i) {
+        CHECK(strcmp(c.lines[i], expected[i]) == 0, "line %d is '%s', expected '%s'", i, c.lines[i], expected[i]);
+    }
+
+    // A line continued over reads, and one left open when the pipe closes.
+    c.count = 0;
+    Feed(&splitter, &c, "par");
+    Feed(&splitter, &c, "tial\nrest");
+    CHECK(c.count == 1 && strcmp(c.lines[0], "0:partial") == 0, "%d lines, first '%s'", c.count, c.lines[0]);
+    LineSplitterFinish(&splitter, Collect, &c);
+    CHECK(c.count == 2 && strcmp(c.lines[1], "0:rest") == 0, "%d lines, last '%s'", c.count, c.lines[1]);
+    LineSplitterFinish(&splitter, Collect, &c);
+    CHECK(c.count == 2, "finishing twice passed on %d lines", c.count);
+
+    // A \r at the very end of a read cannot be told apart from the start of \r\n.
+    c.count = 0;
+    Feed(&splitter, &c, "end\r");
+    CHECK(c.count == 1 && strcmp(c.lines[0], "0:end") == 0, "'%s'", c.lines[0]);
+}
+
+static void TestLongLine(void) {
+    LineSplitter splitter;
+    Collected c = {0};
+    LineSplitterInit(&splitter);
+    static char chunk[PIPE_BUFFER_SIZE];
+    memset(chunk, 'x', sizeof(chunk));
+    LineSplitterFeed(&splitter, chunk, sizeof(chunk), Collect, &c);
+    LineSplitterFeed(&splitter, chunk, sizeof(chunk) - 1, Collect, &c);
+    CHECK(c.count == 0, "%d lines before the buffer filled", c.count);
+    LineSplitterFeed(&splitter, chunk, sizeof(chunk), Collect, &c);
+    CHECK(c.count == 1 && c.lines[0][0] == '2', "%d lines, first '%.4s'", c.count, c.lines[0]);
+    CHECK(c.lengths[0] == 2 * sizeof(chunk) - 1, "part of %zu bytes", c.lengths[0]);
+    LineSplitterFeed(&splitter, "tail\n", 5, Collect, &c);
+    CHECK(c.count == 2 && c.lengths[1] == sizeof(chunk) + 4, "%d lines, last %zu bytes", c.count, c.lengths[1]);
+}
+
+static void TestRateLimit(void) {
+    TaskLogBudget budget;
+    TaskLogBudgetInit(&budget, 1000);
+    int shown = 0;
+    for (int i = 0; i < 1000; ++i) shown += TaskLogBudgetSubmit(&budget, "line", 0, 1000).show;
+    CHECK(shown == LOG_RATE_BURST_LINES, "%d lines shown at once", shown);
+    CHECK(budget.suppressed_lines == 1000 - LOG_RATE_BURST_LINES, "%llu suppressed", budget.suppressed_lines);
+
+    TaskLogDecision d = TaskLogBudgetSubmit(&budget, "line", 0, 1000 + LOG_SUPPRESS_REPORT_MS - 1);
+    CHECK(!d.report_due, "summary due before LOG_SUPPRESS_REPORT_MS");
+    d = TaskLogBudgetSubmit(&budget, "line", 0, 1000 + LOG_SUPPRESS_REPORT_MS);
+    CHECK(d.show && d.report_due, "show %d, report %d after a second", d.show, d.report_due);
+
+    unsigned long long lines, bytes;
+    CHECK(TaskLogBudgetTakeReport(&budget, 2000, &lines, &bytes), "no summary");
+    CHECK(lines == 1000 - LOG_RATE_BURST_LINES && bytes == lines * 4, "summary of %llu lines, %llu bytes", lines, bytes);
+    CHECK(!TaskLogBudgetTakeReport(&budget, 2000, &lines, &bytes), "second summary with nothing suppressed");
+    CHECK(budget.lines_total == 1002 && budget.suppressed_lines_total == 1000 - LOG_RATE_BURST_LINES,
+          "totals %llu / %llu", budget.lines_total, budget.suppressed_lines_total);
+    TaskLogBudgetFree(&budget);
+}
+
+static void TestProgressAndByteBudget(void) {
+    TaskLogBudget budget;
+    TaskLogBudgetInit(&budget, 0);
+    budget.tokens = 0;
+    CHECK(!TaskLogBudgetSubmit(&budget, "10%", 1, 0).show, "shown without a token");
+    CHECK(!TaskLogBudgetSubmit(&budget, "20%", 1, 0).show, "shown without a token");
+    char* progress = TaskLogBudgetTakePendingProgress(&budget);
+    CHECK(progress && strcmp(progress, "20%") == 0, "held back '%s'", progress ? progress : "(null)");
+    free(progress);
+    CHECK(!TaskLogBudgetTakePendingProgress(&budget), "progress handed out twice");
+
+    static char big[64 * 1024];
+    memset(big, 'y', sizeof(big) - 1);
+    int exhausted = 0, shown = 0;
+    for (unsigned long long t = 1000; t < 1000 + 200 * 1000; t += 1000) {
+        TaskLogDecision d = TaskLogBudgetSubmit(&budget, big, 0, t);
+        shown += d.show;
+        exhausted += d.budget_exhausted;
+    }
+    CHECK(shown == (int)(LOG_TASK_BYTE_BUDGET / (sizeof(big) - 1)), "%d big lines shown", shown);
+    CHECK(exhausted == 1, "budget reported %d times", exhausted);
+    CHECK(budget.bytes_shown <= LOG_TASK_BYTE_BUDGET, "%llu bytes shown", budget.bytes_shown);
+    TaskLogBudgetFree(&budget);
+}
+
+int main(void) {
+    TestLineEndings();
+    TestLongLine();
+    TestRateLimit();
+    TestProgressAndByteBudget();
+    printf("tasklog_test: %d checks, %d failed\n", g_checks, g_failures);
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+#include "timerwheel.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(level) ((level) * TIMER_WHEEL_SLOT_BITS)
+#define WHEEL_SPAN (1ULL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) // Ticks the wheel can represent
+
+static void ListInit(TimerEntry* head) {
+    head->next = head;
+    head->prev = head;
+}
+
+static void ListUnlink(TimerEntry* entry) {
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    entry->next = NULL;
+    entry->prev = NULL;
+}
+
+static void ListPushBack(TimerEntry* head, TimerEntry* entry) {
+    entry->prev = head->prev;
+    entry->next = head;
+    head->prev->next = entry;
+    head->prev = entry;
+}
+
+void TimerWheelInit(TimerWheel* wheel, unsigned long long tickMs, unsigned long long nowMs) {
+    wheel->tick_ms = tickMs ? tickMs : 1;
+    wheel->current = nowMs / wheel->tick_ms;
+    wheel->count = 0;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+        for (int slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot) ListInit(&wheel->slots[level][slot]);
+    }
+}
+
+void TimerEntryInit(TimerEntry* entry, void* data) {
+    entry->next = NULL;
+    entry->prev = NULL;
+    entry->expires = 0;
+    entry->data = data;
+}
+
+int TimerEntryArmed(const TimerEntry* entry) {
+    return entry->prev != NULL; // next also chains the list TimerWheelAdvance hands out
+}
+
+// Places an unlinked entry by how far away it is: level L holds entries due within
+// SLOTS^(L+1) ticks, indexed by the tick's L-th group of bits.
+static void WheelInsert(TimerWheel* wheel, TimerEntry* entry) {
+    unsigned long long expires = entry->expires;
+    if (expires < wheel->current) expires = wheel->current;
+    unsigned long long delta = expires - wheel->current;
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1ULL << LEVEL_SHIFT(level + 1))) level++;
+    if (delta >= WHEEL_SPAN) {
+        // Beyond the wheel: park in the last top-level slot and re-sort when it cascades.
+        expires = wheel->current + WHEEL_SPAN - 1;
+    }
+    int slot = (int)((expires >> LEVEL_SHIFT(level)) & SLOT_MASK);
+    ListPushBack(&wheel->slots[level][slot], entry);
+}
+
+void TimerWheelSchedule(TimerWheel* wheel, TimerEntry* entry, unsigned long long dueMs) {
+    if (TimerEntryArmed(entry)) TimerWheelCancel(wheel, entry);
+    entry->expires = (dueMs + wheel->tick_ms - 1) / wheel->tick_ms; // Round up: never early
+    WheelInsert(wheel, entry);
+    wheel->count++;
+}
+
+void TimerWheelCancel(TimerWheel* wheel, TimerEntry* entry) {
+    if (!TimerEntryArmed(entry)) return;
+    ListUnlink(entry);
+    wheel->count--;
+}
+
+// Re-sorts one slot of a higher level into the levels below it.
+static void WheelCascade(TimerWheel* wheel, int level, int slot) {
+    TimerEntry* head = &wheel->slots[level][slot];
+    TimerEntry pending;
+    ListInit(&pending);
+    if (head->next != head) { // Move the whole list aside first, re-insertion may target head
+        pending.next = head->next;
+        pending.prev = head->prev;
+        pending.next->prev = &pending;
+        pending.prev->next = &pending;
+        ListInit(head);
+    }
+    while (pending.next != &pending) {
+        TimerEntry* entry = pending.next;
+        ListUnlink(entry);
+        WheelInsert(wheel, entry);
+    }
+}
+
+size_t TimerWheelAdvance(TimerWheel* wheel, unsigned long long nowMs, TimerEntry** expired) {
+    unsigned long long target = nowMs / wheel->tick_ms;
+    size_t fired = 0;
+    TimerEntry* firedHead = NULL;
+    TimerEntry** firedTail = &firedHead;
+
+    if (wheel->count == 0 && wheel->current <= target) {
+        wheel->current = target + 1; // Nothing to fire, skip the ticks
+    }
+    while (wheel->current <= target) {
+        unsigned long long tick = wheel->current;
+        // At each level boundary, pull the next block of the level above down.
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+            if ((tick & ((1ULL << LEVEL_SHIFT(level)) - 1)) != 0) break;
+            WheelCascade(wheel, level, (int)((tick >> LEVEL_SHIFT(level)) & SLOT_MASK));
+        }
+
+        TimerEntry* head = &wheel->slots[0][tick & SLOT_MASK];
+        while (head->next != head) {
+            TimerEntry* entry = head->next;
+            ListUnlink(entry);
+            wheel->count--;
+            *firedTail = entry;
+            firedTail = &entry->next;
+            fired++;
+        }
+        wheel->current++;
+        if (wheel->count == 0 && wheel->current <= target) wheel->current = target + 1;
+    }
+
+    *firedTail = NULL;
+    // Entries handed out are no longer armed; only their next pointers chain the result.
+    for (TimerEntry* entry = firedHead; entry; entry = entry->next) entry->prev = NULL;
+    *expired = firedHead;
+    return fired;
+}
+
+unsigned long long TimerWheelNextTimeout(const TimerWheel* wheel, unsigned long long nowMs) {
+    if (wheel->count == 0) return TIMER_WHEEL_IDLE;
+
+    // Each level's pending entries fall in a window of SLOTS blocks starting at the first
+    // block that has not been processed (level 0) or cascaded (higher levels), one entry
+    // per slot index. The start of the first occupied block is a lower bound for the
+    // entries in it; the minimum over all levels is when the wheel next needs attention.
+    unsigned long long due = TIMER_WHEEL_IDLE;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+        unsigned long long unit = 1ULL << LEVEL_SHIFT(level);
+        unsigned long long firstBlock = (wheel->current + unit - 1) >> LEVEL_SHIFT(level);
+        for (unsigned long long block = firstBlock; block < firstBlock + TIMER_WHEEL_SLOTS; ++block) {
+            const TimerEntry* head = &wheel->slots[level][block & SLOT_MASK];
+            if (head->next != head) {
+                unsigned long long start = block << LEVEL_SHIFT(level);
+                if (start < due) due = start;
+                break;
+            }
+        }
+    }
+
+    unsigned long long dueMs = due * wheel->tick_ms;
+    return dueMs > nowMs ? dueMs - nowMs : 0;
+}
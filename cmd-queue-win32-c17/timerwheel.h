@@ -0,0 +1,45 @@
+// Hierarchical timer wheel. Plain C with no Win32 dependency; time is always passed in
+// by the caller, so any clock (including a fake one) can drive it.
+#ifndef CMDQ_TIMERWHEEL_H
+#define CMDQ_TIMERWHEEL_H
+
+#include <stddef.h>
+
+#define TIMER_WHEEL_LEVELS    4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS     (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_IDLE      (~0ULL) // TimerWheelNextTimeout: nothing scheduled
+
+// Embed in the owning object; the wheel never allocates.
+typedef struct TimerEntry {
+    struct TimerEntry* next;
+    struct TimerEntry* prev;
+    unsigned long long expires; // Tick at which the entry fires
+    void* data;                 // Owner's context, untouched by the wheel
+} TimerEntry;
+
+typedef struct {
+    unsigned long long tick_ms;
+    unsigned long long current;  // Next tick to process; everything before it has fired
+    size_t count;
+    TimerEntry slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; // List heads
+} TimerWheel;
+
+void TimerWheelInit(TimerWheel* wheel, unsigned long long tickMs, unsigned long long nowMs);
+void TimerEntryInit(TimerEntry* entry, void* data);
+int TimerEntryArmed(const TimerEntry* entry);
+
+// (Re)schedules entry to fire at dueMs, never earlier. A time in the past fires on the next advance.
+void TimerWheelSchedule(TimerWheel* wheel, TimerEntry* entry, unsigned long long dueMs);
+void TimerWheelCancel(TimerWheel* wheel, TimerEntry* entry);
+
+// Processes every tick up to nowMs. Entries that fired are unlinked and returned as a list
+// chained through next (NULL-terminated); the return value is how many there are. Read an
+// entry's next before rescheduling it.
+size_t TimerWheelAdvance(TimerWheel* wheel, unsigned long long nowMs, TimerEntry** expired);
+
+// Milliseconds from nowMs until the wheel next needs TimerWheelAdvance, or TIMER_WHEEL_IDLE.
+// May be earlier than the next expiry (a higher level is due to cascade), never later.
+unsigned long long TimerWheelNextTimeout(const TimerWheel* wheel, unsigned long long nowMs);
+
+#endif // CMDQ_TIMERWHEEL_H
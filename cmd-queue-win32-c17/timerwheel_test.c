@@ -0,0 +1,190 @@
+// Host-built checks for timerwheel.c, driven by a mock clock (make test).
+#include <stdio.h>
+
+#include "timerwheel.h"
+
+#define TICK_MS      100
+#define ENTRY_COUNT  512
+#define WHEEL_TICKS  (1ULL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS))
+
+static int g_checks = 0;
+static int g_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    g_checks++; \
+    if (!(cond)) { \
+        g_failures++; \
+        fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, #cond); \
+        fprintf(stderr, __VA_ARGS__); \
+        fputc('\n', stderr); \
+    } \
+} while (0)
+
+// Deterministic xorshift, so a failure reproduces.
+static unsigned long long g_rng = 0x9E3779B97F4A7C15ULL;
+static unsigned long long Random(unsigned long long bound) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return bound ? g_rng % bound : 0;
+}
+
+// Shadow state of each entry: what the wheel should be doing with it.
+typedef struct {
+    TimerEntry timer;
+    int armed;
+    unsigned long long due_ms;
+    unsigned long long fire_tick; // Due tick, or the next unprocessed tick if that has passed
+} TestTimer;
+
+static TestTimer g_timers[ENTRY_COUNT];
+static TimerWheel g_wheel;
+static unsigned long long g_nowMs; // The mock clock
+
+static void ResetWheel(unsigned long long startMs) {
+    g_nowMs = startMs;
+    TimerWheelInit(&g_wheel, TICK_MS, g_nowMs);
+    for (int i = 0; i < ENTRY_COUNT; ++i) {
+        TimerEntryInit(&g_timers[i].timer, &g_timers[i]);
+        g_timers[i].armed = 0;
+    }
+}
+
+static void Schedule(TestTimer* t, unsigned long long dueMs) {
+    TimerWheelSchedule(&g_wheel, &t->timer, dueMs);
+    t->armed = 1;
+    t->due_ms = dueMs;
+    t->fire_tick = (dueMs + TICK_MS - 1) / TICK_MS;
+    if (t->fire_tick <= g_nowMs / TICK_MS) t->fire_tick = g_nowMs / TICK_MS + 1; // That tick was processed
+}
+
+// Moves the clock to nowMs and checks what fires: nothing early, nothing left overdue,
+// and at most maxLateMs past the tick it was due on.
+static void AdvanceTo(unsigned long long nowMs, unsigned long long maxLateMs) {
+    g_nowMs = nowMs;
+    TimerEntry* expired;
+    size_t fired = TimerWheelAdvance(&g_wheel, g_nowMs, &expired);
+    size_t listed = 0;
+    for (TimerEntry* e = expired; e; ) {
+        TimerEntry* next = e->next;
+        TestTimer* t = (TestTimer*)e->data;
+        CHECK(t->armed, "entry %d fired while not armed", (int)(t - g_timers));
+        CHECK(g_nowMs >= t->due_ms, "fired early: now %llu, due %llu", g_nowMs, t->due_ms);
+        CHECK(g_nowMs - t->fire_tick * TICK_MS <= maxLateMs, "fired late: now %llu, due %llu", g_nowMs, t->due_ms);
+        CHECK(!TimerEntryArmed(e), "fired entry still armed");
+        t->armed = 0;
+        listed++;
+        e = next;
+    }
+    CHECK(fired == listed, "returned %zu, listed %zu", fired, listed);
+
+    size_t armed = 0;
+    for (int i = 0; i < ENTRY_COUNT; ++i) {
+        if (!g_timers[i].armed) continue;
+        armed++;
+        CHECK(g_timers[i].fire_tick * TICK_MS > g_nowMs, "overdue: now %llu, due %llu", g_nowMs, g_timers[i].due_ms);
+    }
+    CHECK(armed == g_wheel.count, "wheel counts %zu, expected %zu", g_wheel.count, armed);
+}
+
+// TimerWheelNextTimeout may be early (to cascade) but never later than the next expiry.
+static unsigned long long CheckNextTimeout(void) {
+    unsigned long long earliest = TIMER_WHEEL_IDLE;
+    for (int i = 0; i < ENTRY_COUNT; ++i) {
+        if (g_timers[i].armed && g_timers[i].fire_tick * TICK_MS < earliest) earliest = g_timers[i].fire_tick * TICK_MS;
+    }
+    unsigned long long timeout = TimerWheelNextTimeout(&g_wheel, g_nowMs);
+    if (earliest == TIMER_WHEEL_IDLE) {
+        CHECK(timeout == TIMER_WHEEL_IDLE, "empty wheel returned %llu", timeout);
+    } else {
+        CHECK(timeout != TIMER_WHEEL_IDLE && g_nowMs + timeout <= earliest,
+              "now %llu + timeout %llu is past the next expiry %llu", g_nowMs, timeout, earliest);
+    }
+    return timeout;
+}
+
+static void TestRandomized(void) {
+    ResetWheel(1234567);
+    for (int step = 0; step < 200000; ++step) {
+        TestTimer* t = &g_timers[Random(ENTRY_COUNT)];
+        switch (Random(8)) {
+        case 0: // Cancel
+            TimerWheelCancel(&g_wheel, &t->timer);
+            t->armed = 0;
+            break;
+        case 1: // Past or present: fires on the next advance
+            Schedule(t, g_nowMs - Random(g_nowMs < 5000 ? g_nowMs : 5000));
+            break;
+        case 2: case 3: // Near, within the first level
+            Schedule(t, g_nowMs + Random(64 * TICK_MS));
+            break;
+        default: // Anywhere up to the higher levels (reschedules armed entries too)
+            Schedule(t, g_nowMs + Random(1ULL << (Random(4) * 6 + 6)) * TICK_MS + Random(TICK_MS));
+            break;
+        }
+        // Move the clock by at most one tick, so nothing may be more than a tick late.
+        unsigned long long stepMs = 1 + Random(TICK_MS);
+        AdvanceTo(g_nowMs + stepMs, stepMs);
+        CheckNextTimeout();
+    }
+}
+
+// Sleeping exactly TimerWheelNextTimeout, as the worker loop does, must fire every
+// entry on its tick, including ones beyond the wheel's span that are parked and re-sorted.
+static void TestSleepUntilTimeout(void) {
+    ResetWheel(777);
+    unsigned long long spanMs = WHEEL_TICKS * TICK_MS;
+    Schedule(&g_timers[0], g_nowMs + 250);
+    Schedule(&g_timers[1], g_nowMs + 64 * 64 * TICK_MS + 30);
+    Schedule(&g_timers[2], g_nowMs + spanMs - TICK_MS);
+    Schedule(&g_timers[3], g_nowMs + spanMs + 12345);
+    Schedule(&g_timers[4], g_nowMs + 3 * spanMs + 1);
+    for (int i = 5; i < 64; ++i) Schedule(&g_timers[i], g_nowMs + Random(5 * spanMs));
+
+    int wakeups = 0;
+    while (g_wheel.count > 0 && wakeups < 100000) {
+        unsigned long long timeout = CheckNextTimeout();
+        if (timeout == TIMER_WHEEL_IDLE) break;
+        AdvanceTo(g_nowMs + (timeout ? timeout : 1), TICK_MS - 1);
+        wakeups++;
+    }
+    CHECK(g_wheel.count == 0, "%zu entries never fired", g_wheel.count);
+    CHECK(wakeups < 2000, "%d wakeups to drain 64 timers", wakeups);
+}
+
+static void TestCancelAndReschedule(void) {
+    ResetWheel(0);
+    TestTimer* a = &g_timers[0];
+    TestTimer* b = &g_timers[1];
+
+    Schedule(a, 1000);
+    TimerWheelCancel(&g_wheel, &a->timer);
+    a->armed = 0;
+    CHECK(!TimerEntryArmed(&a->timer), "cancelled entry still armed");
+    TimerWheelCancel(&g_wheel, &a->timer); // Cancelling twice is harmless
+    AdvanceTo(5000, 0);
+
+    Schedule(a, 9000);
+    Schedule(a, 6000);          // Earlier: moves, does not duplicate
+    Schedule(b, 6000);
+    Schedule(b, 8000);          // Later
+    CHECK(g_wheel.count == 2, "count %zu after rescheduling", g_wheel.count);
+    AdvanceTo(5900, 0);
+    AdvanceTo(6000, 0);         // a fires here
+    CHECK(!a->armed, "a did not fire at 6000");
+    Schedule(a, 6050);          // Fired entries can be scheduled again
+    AdvanceTo(6100, 0);
+    CHECK(!a->armed, "a did not fire again at 6100");
+    AdvanceTo(7999, 0);
+    AdvanceTo(8000, 0);         // b fires here
+    CHECK(!b->armed, "b did not fire at 8000");
+    CHECK(CheckNextTimeout() == TIMER_WHEEL_IDLE, "wheel not idle after all fired");
+}
+
+int main(void) {
+    TestCancelAndReschedule();
+    TestSleepUntilTimeout();
+    TestRandomized();
+    printf("timerwheel_test: %d checks, %d failed\n", g_checks, g_failures);
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,33 @@
+#include "window_layout.h"
+
+// Sizes in 96-DPI pixels. The log pane is the only flexible part and takes all extra height;
+// the suffix edit takes all extra width in the input row. Zero-size spacers double the
+// gap between sections; the trailing one keeps the original 15px below the input row.
+static const LayoutNode g_inputRowItems[] = {
+    { .kind = LAYOUT_LEAF, .fixed = 90,  .slot = SLOT_GROUP_COMBO },
+    { .kind = LAYOUT_LEAF, .fixed = 110, .slot = SLOT_PROFILE_COMBO },
+    { .kind = LAYOUT_LEAF, .fixed = 80,  .slot = SLOT_INPUT_LABEL },
+    { .kind = LAYOUT_LEAF, .flex = 1, .min_size = 60, .slot = SLOT_INPUT_EDIT },
+    { .kind = LAYOUT_LEAF, .fixed = 100, .slot = SLOT_BUTTON_ADD },
+    { .kind = LAYOUT_LEAF, .fixed = 70,  .slot = SLOT_BUTTON_EXPORT },
+};
+
+static const LayoutNode g_mainColumnItems[] = {
+    { .kind = LAYOUT_LEAF, .fixed = 20, .slot = SLOT_PREFIX_LABEL },
+    { .kind = LAYOUT_LEAF, .fixed = 25, .slot = SLOT_PREFIX_EDIT },
+    { .kind = LAYOUT_LEAF, .fixed = 0,  .slot = LAYOUT_NO_SLOT },
+    { .kind = LAYOUT_LEAF, .fixed = 20, .slot = SLOT_DASHBOARD_LABEL },
+    { .kind = LAYOUT_LEAF, .fixed = 80, .slot = SLOT_DASHBOARD },
+    { .kind = LAYOUT_LEAF, .fixed = 0,  .slot = LAYOUT_NO_SLOT },
+    { .kind = LAYOUT_LEAF, .fixed = 20, .slot = SLOT_LOG_LABEL },
+    { .kind = LAYOUT_LEAF, .flex = 1, .min_size = 50, .slot = SLOT_LOG },
+    { .kind = LAYOUT_LEAF, .fixed = 0,  .slot = LAYOUT_NO_SLOT },
+    { .kind = LAYOUT_ROW, .fixed = 25, .gap = 5, .slot = LAYOUT_NO_SLOT,
+      .children = g_inputRowItems, .child_count = sizeof(g_inputRowItems) / sizeof(g_inputRowItems[0]) },
+    { .kind = LAYOUT_LEAF, .fixed = 0,  .slot = LAYOUT_NO_SLOT },
+};
+
+const LayoutNode g_mainLayout = {
+    .kind = LAYOUT_COLUMN, .padding = 10, .gap = 5, .slot = LAYOUT_NO_SLOT,
+    .children = g_mainColumnItems, .child_count = sizeof(g_mainColumnItems) / sizeof(g_mainColumnItems[0])
+};
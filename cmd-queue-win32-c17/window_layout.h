@@ -0,0 +1,27 @@
+// The main window's layout tree. Kept apart from main.c (and free of Win32) so the
+// geometry can be checked by layout_test.c on any platform.
+#ifndef CMDQ_WINDOW_LAYOUT_H
+#define CMDQ_WINDOW_LAYOUT_H
+
+#include "layout.h"
+
+// --- Layout Slots (one per control placed by the layout tree) ---
+enum {
+    SLOT_PREFIX_LABEL,
+    SLOT_PREFIX_EDIT,
+    SLOT_DASHBOARD_LABEL,
+    SLOT_DASHBOARD,
+    SLOT_LOG_LABEL,
+    SLOT_LOG,
+    SLOT_GROUP_COMBO,
+    SLOT_PROFILE_COMBO,
+    SLOT_INPUT_LABEL,
+    SLOT_INPUT_EDIT,
+    SLOT_BUTTON_ADD,
+    SLOT_BUTTON_EXPORT,
+    SLOT_COUNT
+};
+
+extern const LayoutNode g_mainLayout;
+
+#endif // CMDQ_WINDOW_LAYOUT_H